@@ -5,28 +5,37 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../app.c \
+../crc.c \
+../frame.c \
 ../gpio.c \
 ../keypad.c \
 ../lcd.c \
 ../main.c \
+../password.c \
 ../timer.c \
 ../uart.c 
 
 OBJS += \
 ./app.o \
+./crc.o \
+./frame.o \
 ./gpio.o \
 ./keypad.o \
 ./lcd.o \
 ./main.o \
+./password.o \
 ./timer.o \
 ./uart.o 
 
 C_DEPS += \
 ./app.d \
+./crc.d \
+./frame.d \
 ./gpio.d \
 ./keypad.d \
 ./lcd.d \
 ./main.d \
+./password.d \
 ./timer.d \
 ./uart.d 
 
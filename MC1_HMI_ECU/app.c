@@ -19,11 +19,18 @@
 #include "keypad.h"
 #include "string.h"
 #include "uart.h"
+#include "frame.h"
 #include "timer.h"
 #include "util/delay.h"
 
 volatile uint8 g_flag = 0;
 
+/* Number of the next request, the resent copies of a request keep its number */
+static uint8 g_requestSeq = APP_SEQ_UNNUMBERED;
+
+_Static_assert(sizeof(APP_DiagnosticsType) <= FRAME_MAX_PAYLOAD,
+		"APP_DiagnosticsType must fit in one reply frame");
+
 /*******************************************************************************
  CALL-BACK FUNCTIONS
  ********************************************************************************/
@@ -48,24 +55,201 @@ static void APP_timerControlLCD(void) {
 	}
 }
 
+/*******************************************************************************
+ PRIVATE FUNCTIONS
+ ********************************************************************************/
+
 /**
- * @brief Timer callback to control the error state duration.
+ * @brief Send a request frame to the Control ECU and wait for its reply frame.
+ *
+ * The whole request travels as one frame. It is resent up to APP_MAX_RETRIES times
+ * if the Control ECU answers with APP_NACK, the reply frame arrives corrupted or
+ * no reply arrives within APP_RESPONSE_TIMEOUT_MS, so a dead or reset Control ECU
+ * is detected in a bounded time instead of hanging the HMI.
+ * Every copy carries the same sequence number, the Control ECU answers a copy of a
+ * request it already ran with its kept reply, so a lost reply does not run a password
+ * check or open the door twice. A reply to another number is a late one and is dropped.
  *
- * This function is a timer callback that controls the error state duration. It is called to clear
- * the LCD screen and reset the timer after a specific period.
+ * @return SUCCESS with the reply stored in Response_Ptr, or LINK_ERROR if no valid reply was received.
  */
 
-static void APP_timerControlErrorState(void) {
-	static uint8 tickThreeSeconds = 0;
-	tickThreeSeconds++;
-	if (tickThreeSeconds == WARNING_TIME) {
+static uint8 APP_exchange(uint8 type, const uint8 *payload, uint8 length,
+		FRAME_Type *Response_Ptr) {
+	uint8 state = LINK_ERROR;
+
+	FRAME_setSequence(g_requestSeq);
+	for (uint8 attempt = 0; attempt < APP_MAX_RETRIES; attempt++) {
+		/* Drop a late reply to a previous attempt */
+		FRAME_flush();
+		FRAME_send(type, payload, length);
+		if (FRAME_receiveTimeout(Response_Ptr, APP_RESPONSE_TIMEOUT_MS) == FRAME_COMPLETE
+				&& Response_Ptr->type != APP_NACK && Response_Ptr->seq == g_requestSeq) {
+			state = SUCCESS;
+			break;
+		}
+	}
+
+	/* The unnumbered value is only used once, after a reset */
+	g_requestSeq++;
+	if (g_requestSeq == APP_SEQ_UNNUMBERED) {
+		g_requestSeq++;
+	}
+	return state;
+}
+
+/**
+ * @brief Send a request frame to the Control ECU and wait for its APP_RESPONSE.
+ *
+ * @return The status byte of the response, or LINK_ERROR if no valid response was received.
+ */
+
+static uint8 APP_request(uint8 type, const uint8 *payload, uint8 length) {
+	FRAME_Type response;
+	uint8 state = LINK_ERROR;
+
+	if (APP_exchange(type, payload, length, &response) == SUCCESS
+			&& response.type == APP_RESPONSE && response.length == 1) {
+		state = response.payload[0];
+	}
+	return state;
+}
+
+/**
+ * @brief Wait for the next key of a password entry that already has count digits.
+ *
+ * A digit is taken while the entry is shorter than PASSWORD_MAX_LENGTH and the Enter
+ * button once it holds PASSWORD_MIN_LENGTH digits, any other key is ignored.
+ *
+ * @return The digit (0 .. 9) or ENTER_BUTTON.
+ */
+
+static uint8 APP_readPasswordKey(uint8 count) {
+	uint8 key;
+
+	do {
+		key = KEYPAD_getPressedKey();
+	} while (!(key <= 9 && count < PASSWORD_MAX_LENGTH)
+			&& !(key == ENTER_BUTTON && count >= PASSWORD_MIN_LENGTH));
+	return key;
+}
+
+/**
+ * @brief Read a password from the keypad, displayed as asterisks, until the Enter button.
+ *
+ * @return The number of bytes of its packed form written to packed, which must hold
+ * PASSWORD_MAX_PACKED_SIZE bytes.
+ */
+
+static uint8 APP_enterPassword(uint8 *packed) {
+	uint8 digits[PASSWORD_MAX_LENGTH];
+	uint8 count = 0;
+	uint8 key;
+
+	while ((key = APP_readPasswordKey(count)) != ENTER_BUTTON) {
+		digits[count++] = key;
+		LCD_displayCharacter('*');
+		_delay_ms(500); // Press time delay
+	}
+	_delay_ms(500); // Press time delay
+
+	return PASSWORD_pack(digits, count, packed);
+}
+
+/**
+ * @brief Display the result of a user management request until a key is pressed.
+ */
+
+static void APP_displayResult(uint8 state, const char *successMessage, const char *failMessage) {
+	LCD_clearScreen();
+	if (state == SUCCESS) {
+		LCD_displayString(successMessage);
+	} else if (state == FAILED) {
+		LCD_displayString(failMessage);
+	} else if (state == LOCKED_OUT) {
+		LCD_displayString("Locked Out");
+	} else {
+		LCD_displayString("Link Error");
+	}
+	_delay_ms(1000);
+}
+
+/**
+ * @brief Display the audit log of the Control ECU, newest event first.
+ *
+ * The log is streamed in APP_AUDIT chunks. Every event stays on the LCD until a key is
+ * pressed, the Enter button leaves the log.
+ */
+
+static void APP_showAuditLog(void) {
+	static const char * const eventNames[] = { "?", "Unlock", "Wrong Pass",
+			"Lockout", "Pass Change", "User Added", "User Removed" };
+	FRAME_Type response;
+	APP_AuditEventType event;
+	uint16 index = 0;
+	uint8 key = 0;
+
+	while (key != ENTER_BUTTON) {
+		if (APP_exchange(APP_GET_AUDIT, (const uint8 *) &index, sizeof(index), &response) != SUCCESS
+				|| response.type != APP_AUDIT) {
+			LCD_clearScreen();
+			LCD_displayString("Link Error");
+			_delay_ms(500);
+			return;
+		}
+		if (response.length < sizeof(event)) {
+			break; /* Past the oldest event */
+		}
+
+		for (uint8 i = 0; i + sizeof(event) <= response.length && key != ENTER_BUTTON;
+				i += sizeof(event)) {
+			memcpy(&event, &response.payload[i], sizeof(event));
+			LCD_clearScreen();
+			LCD_displayCharacter('#');
+			LCD_intgerToString(event.seq);
+			if (event.user != APP_NO_USER) {
+				LCD_displayString(" User ");
+				LCD_intgerToString(event.user);
+			}
+			LCD_moveCursor(1, 0);
+			LCD_displayString(eventNames[(event.type <= AUDIT_USER_REMOVED) ? event.type : 0]);
+			key = KEYPAD_getPressedKey();
+			_delay_ms(500); /* Press time */
+			index++;
+		}
+	}
+
+	if (key != ENTER_BUTTON) {
 		LCD_clearScreen();
-		Timer1_deInit();
-		tickThreeSeconds = 0;
-		g_flag = 1;
+		LCD_displayString("End of Log");
+		_delay_ms(1000);
 	}
 }
 
+/**
+ * @brief Display a set of UART link health counters on the LCD and wait for a key.
+ */
+
+static void APP_displayStatistics(const char *title,
+		const UART_StatisticsType *Stats_Ptr, uint16 frameErrors) {
+	LCD_clearScreen();
+	LCD_displayString(title);
+	LCD_displayString(" FE");
+	LCD_intgerToString(Stats_Ptr->framing_errors);
+	LCD_displayString(" PE");
+	LCD_intgerToString(Stats_Ptr->parity_errors);
+	LCD_moveCursor(1, 0);
+	LCD_displayString("OV");
+	LCD_intgerToString(Stats_Ptr->overrun_errors + Stats_Ptr->buffer_overflows);
+	LCD_displayString(" CRC");
+	LCD_intgerToString(frameErrors);
+	LCD_displayString(" HW");
+	LCD_intgerToString(Stats_Ptr->rx_high_water);
+	LCD_displayCharacter('/');
+	LCD_intgerToString(Stats_Ptr->tx_high_water);
+	KEYPAD_getPressedKey();
+	_delay_ms(500); /* Press time */
+}
+
 /*******************************************************************************
  FUNCTIONS DEFINITION
  ********************************************************************************/
@@ -78,8 +262,7 @@ static void APP_timerControlErrorState(void) {
  */
 
 void APP_init(void) {
-	UART_ConfigType UART_Config_Data = { bit_8, Enabled_Even, bit_1, 9600 };
-	UART_init(&UART_Config_Data);
+	UART_init();
 	LCD_init();
 	LCD_clearScreen();
 	LCD_displayStringRowColumn(0, 3, "Welcome :)");
@@ -89,24 +272,57 @@ void APP_init(void) {
 }
 
 /**
- * @brief Send an error message and set a timer for controlling error state.
+ * @brief Raise the alarm and show the lockout of the Control ECU until it ends.
  *
- * This function sends an error message via UART, displays an error message on the LCD,
- * and sets a timer to control the error state. The timer callback function is used to
- * handle the error state.
+ * This function sends an error message via UART and displays an error message on the LCD.
+ * The Control ECU keeps the time of a wrong password lockout, it is asked for the seconds
+ * left once a second and they are counted down on the LCD. A reset of the HMI does not end
+ * a lockout, the Control ECU refuses every password until its time is over.
  */
 
 void APP_sendError(void) {
+	FRAME_Type response;
+	uint16 remaining = 0;
 
-	UART_sendByte(APP_SEND_ERROR);
+	APP_request(APP_SEND_ERROR, NULL_PTR, 0);
 	LCD_clearScreen();
 	LCD_displayStringRowColumn(0, 0, "ERROR :(");
-	Timer_ConfigType timerConfigData = { 0, CTC_VALUE, F_CPU_1024, CTC_MODE };
-	TIMER1_init(&timerConfigData);
-	Timer1_setCallBack(APP_timerControlErrorState);
-	while (g_flag != 1)
-		;
-	g_flag = 0;
+	_delay_ms(1000);
+
+	while (APP_exchange(APP_GET_LOCKOUT, NULL_PTR, 0, &response) == SUCCESS
+			&& response.type == APP_LOCKOUT && response.length == sizeof(remaining)) {
+		memcpy(&remaining, response.payload, sizeof(remaining));
+		if (remaining == 0)
+			break;
+		LCD_clearScreen();
+		LCD_displayString("Locked Out");
+		LCD_displayStringRowColumn(1, 0, "Retry in ");
+		LCD_intgerToString(remaining);
+		LCD_displayString(" s");
+		_delay_ms(1000);
+	}
+	LCD_clearScreen();
+}
+
+/**
+ * @brief Ask the Control ECU whether the first password is still to be set.
+ *
+ * The administrator password is created at the first start only, once it is set the
+ * Control ECU refuses a new one unless the current one was checked just before.
+ * The question is asked again until the Control ECU answers.
+ *
+ * @return TRUE if no password was set yet.
+ */
+
+boolean APP_needsSetup(void) {
+	uint8 state;
+
+	while ((state = APP_request(APP_NEEDS_SETUP, NULL_PTR, 0)) == LINK_ERROR) {
+		LCD_clearScreen();
+		LCD_displayString("Link Error");
+		_delay_ms(500);
+	}
+	return (state == SUCCESS);
 }
 
 /**
@@ -114,13 +330,19 @@ void APP_sendError(void) {
  *
  * This function allows the user to create a password by entering it twice for confirmation.
  * The password is entered through a keypad, and it is displayed on an LCD screen as asterisks.
+ * It has PASSWORD_MIN_LENGTH to PASSWORD_MAX_LENGTH digits and is ended by the Enter button.
  * After confirming the password, it is sent to the Control_ECU for storage if the two entered
  * passwords match. If they don't match, the user is given a limited number of attempts.
+ * A change is only accepted by the Control ECU right after the current password was
+ * checked with APP_CHECK_PASS, otherwise it is answered FAILED.
  *
  * @return uint8_t The function returns one of the following status codes:
  * - SUCCESS: The password was created and saved successfully.
  * - RE_CALL: The password did not match, and it's the first function call.
- * - FATAL_ERROR: The password did not match, and the maximum number of attempts is reached.
+ * - FATAL_ERROR: The password did not match, and the maximum number of attempts is reached,
+ *   or the Control ECU is in a wrong password lockout.
+ *
+ * A LINK_ERROR does not count as an attempt, the user is asked to enter the password again.
  *
  *	[UPDATE]: Instead of compare the two passwords there, and send
  *	if the two passwords are the same [NOW] we send the two passwords
@@ -130,14 +352,11 @@ void APP_sendError(void) {
 uint8_t APP_createChangePassword(void) {
 	// Static variable to keep track of function calls
 	static uint8_t funcCallCount = 0;
-	uint8_t txFirstPassword[PASSWORD_LENGTH] = { 0 };
-	uint8_t txSecondPassword[PASSWORD_LENGTH] = { 0 };
-	uint8_t i = 0;
+	/* The two entered passwords are sent back to back in one frame, each in its packed form */
+	uint8_t txPasswords[2 * PASSWORD_MAX_PACKED_SIZE] = { 0 };
+	uint8_t size = 0;
 	uint8_t state = SUCCESS;
 
-	// Increment the function call count
-	funcCallCount++;
-
 	LCD_clearScreen();
 	LCD_displayStringRowColumn(0, 0, "ENTER NEW");
 	LCD_displayStringRowColumn(1, 0, "PASSWORD");
@@ -149,63 +368,35 @@ uint8_t APP_createChangePassword(void) {
 	LCD_moveCursor(1, 0);
 
 	// Receive the first part of the password
-	while (i < PASSWORD_LENGTH) {
-		txFirstPassword[i] = KEYPAD_getPressedKey();
-		LCD_displayCharacter('*');
-		i++;
-		_delay_ms(500); // Press time delay
-	}
-
-	// Wait for the Enter button to be pressed
-	while (KEYPAD_getPressedKey() != ENTER_BUTTON)
-		;
-	_delay_ms(500); // Press time delay
+	size = APP_enterPassword(&txPasswords[0]);
 
 	// Display a message for re-entering the password
 	LCD_clearScreen();
 	LCD_displayStringRowColumn(0, 0, "Plz Re-Enter the");
 	LCD_displayStringRowColumn(1, 0, "same pass:");
 
-	i = 0;
-
 	// Receive the second part of the password
-	while (i < PASSWORD_LENGTH) {
-		txSecondPassword[i] = KEYPAD_getPressedKey();
-		LCD_displayCharacter('*');
-		i++;
-		_delay_ms(500); // Press time delay
-	}
-
-	// Wait for the Enter button to be pressed
-	while (KEYPAD_getPressedKey() != ENTER_BUTTON)
-		;
-	_delay_ms(500); // Press time delay
-
-	// Send a request to save the passwords
-	UART_sendByte(APP_SAVE_PASS);
-
-	// Wait for an acknowledgment from the UART
-	while (UART_recieveByte() != ACKNOWLEDGEMENT)
-		;
-
-	// Send the first password to be saved
-	for (uint8_t i = 0; i < PASSWORD_LENGTH; i++) {
-		UART_sendByte(txFirstPassword[i]);
-	}
-
-	// Send the second password to be saved
-	for (uint8_t i = 0; i < PASSWORD_LENGTH; i++) {
-		UART_sendByte(txSecondPassword[i]);
-	}
+	size += APP_enterPassword(&txPasswords[size]);
 
-	// Receive the state of the password saving process
-	state = UART_recieveByte();
+	// Send the two passwords and receive the state of the password saving process
+	state = APP_request(APP_SAVE_PASS, txPasswords, size);
 
 	if (state == SUCCESS) {
 		// Reset the function call count and return SUCCESS
 		funcCallCount = 0;
 		state = SUCCESS;
+	} else if (state == LINK_ERROR) {
+		// No valid reply from the Control ECU, enter the password again
+		LCD_clearScreen();
+		LCD_displayString("Link Error");
+		_delay_ms(500);
+		state = RE_CALL;
+	} else if (state == LOCKED_OUT) {
+		// The Control ECU refuses passwords until its lockout is over
+		state = FATAL_ERROR;
 	} else if (state == FAILED) {
+		// Increment the function call count
+		funcCallCount++;
 		if (funcCallCount >= MAX_NUM_REP) {
 			// Handle the case of a password mismatch and reaching the maximum attempts
 			state = FATAL_ERROR;
@@ -232,6 +423,7 @@ uint8_t APP_createChangePassword(void) {
  * @return uint8 The function returns one of the following options based on user choice:
  * - OPEN_DOOR: User chooses to open the door.
  * - CHANGE_PASS: User chooses to change the password.
+ * - DIAGNOSTICS: Hidden choice, not shown on the LCD, to display the link health counters.
  */
 
 uint8 APP_displayMainOption(void) {
@@ -243,12 +435,13 @@ uint8 APP_displayMainOption(void) {
 
 	LCD_displayStringRowColumn(0, 0, "+ : Open Door");
 
-	LCD_displayStringRowColumn(1, 0, "- : Change Pass");
+	LCD_displayStringRowColumn(1, 0, "-:Pass  %:Users");
 
 	do {
 		key = KEYPAD_getPressedKey();
 		_delay_ms(500); /* Press time */
-	} while (key != OPEN_DOOR && key != CHANGE_PASS);
+	} while (key != OPEN_DOOR && key != CHANGE_PASS && key != MANAGE_USERS
+			&& key != DIAGNOSTICS);
 
 	switch (key) {
 	case OPEN_DOOR:
@@ -257,25 +450,43 @@ uint8 APP_displayMainOption(void) {
 	case CHANGE_PASS:
 		state = CHANGE_PASS;
 		break;
+	case MANAGE_USERS:
+		state = MANAGE_USERS;
+		break;
+	case DIAGNOSTICS:
+		state = DIAGNOSTICS;
+		break;
 	}
 	return state;
 }
 
 /**
- * @brief Open the door by entering a password.
+ * @brief Enter a password and send it with the given request.
  *
- * This function allows the user to enter a password to open the door.
+ * This function allows the user to enter a password to open the door or to change the password.
  * It communicates with the keypad, UART, and LCD for this purpose.
  *
- * @return An error code indicating the outcome of the door opening attempt.
+ * @param request APP_CHECK_PASS to only verify the password, or APP_VERIFY_UNLOCK to let the
+ * Control ECU verify the password and open the door in the same request.
+ *
+ * With APP_STREAM_DIGITS every digit is forwarded as soon as it is pressed and compared on the
+ * Control ECU while the user keeps typing, the Enter button only asks for the ready verdict.
+ * Without it the password is sent in its packed form (see password.h) after the Enter button.
+ *
+ * The wrong passwords are counted by the Control ECU, it answers LOCKED_OUT to the one that
+ * starts a lockout and to every password during it, so a reset of the HMI does not give
+ * more attempts.
+ *
+ * @return An error code indicating the outcome of the password check.
  */
 
-uint8 APP_checkPassword(void) {
-	static uint8 funcCallCount = 0;
-	funcCallCount++;
-
-	uint8 pass[PASSWORD_LENGTH] = { 0 };
+uint8 APP_checkPassword(uint8 request) {
+#ifdef APP_STREAM_DIGITS
 	uint8 i = 0;
+#else
+	uint8 pass[PASSWORD_MAX_PACKED_SIZE] = { 0 };
+	uint8 size = 0;
+#endif
 	uint8 state = 0;
 	uint8 receivedByte = 0;
 
@@ -287,58 +498,169 @@ uint8 APP_checkPassword(void) {
 	LCD_displayStringRowColumn(0, 0, "Plz Enter Pass:");
 	LCD_moveCursor(1, 0);
 
-	while (i < PASSWORD_LENGTH) {
-		pass[i] = KEYPAD_getPressedKey();
+#ifdef APP_STREAM_DIGITS
+	/* Any lost exchange spoils the whole entry */
+	receivedByte = APP_request(APP_ENTRY_START, NULL_PTR, 0);
+
+	for (uint8 key = APP_readPasswordKey(i); key != ENTER_BUTTON; key = APP_readPasswordKey(i)) {
+		uint8 digit[2] = { i, key };
+		if (receivedByte == SUCCESS) {
+			receivedByte = APP_request(APP_ENTRY_DIGIT, digit, sizeof(digit));
+		}
 		LCD_displayCharacter('*');
 		i++;
 		_delay_ms(500); // Use a separate delay function
 	}
 
-	while (KEYPAD_getPressedKey() != '=')
-		;
-	_delay_ms(500); // Use a separate delay function
-
-	UART_sendByte(APP_CHECK_PASS);
-	_delay_ms(15); // Use a separate delay function
-
-	for (uint8 i = 0; i < PASSWORD_LENGTH; i++) {
-		UART_sendByte(pass[i]);
+	/* The Control ECU takes the length of the entry from the number of digits it received */
+	if (receivedByte == SUCCESS) {
+		receivedByte = APP_request(APP_ENTRY_COMMIT, &request, 1);
+	} else {
+		receivedByte = LINK_ERROR;
 	}
+	_delay_ms(500); // Use a separate delay function
+#else
+	size = APP_enterPassword(pass);
 
-	receivedByte = UART_recieveByte();
+	receivedByte = APP_request(request, pass, size);
+#endif
 
 	switch (receivedByte) {
 	case SUCCESS:
-		funcCallCount = 0;
 		state = SUCCESS;
 		break;
+	case LINK_ERROR:
+		/* No valid reply from the Control ECU, not counted as an attempt */
+		LCD_clearScreen();
+		LCD_displayString("Link Error");
+		_delay_ms(500);
+		state = RE_CALL;
+		break;
 	case FAILED:
-		if (funcCallCount >= MAX_NUM_REP) {
-			funcCallCount = 0;
-			state = FATAL_ERROR;
-		} else {
-			LCD_clearScreen();
-			LCD_displayString("Wrong Password");
-			LCD_displayStringRowColumn(1,0,"No. Attempt ");
-			LCD_intgerToString(funcCallCount);
-			_delay_ms(500);
-			state = RE_CALL;
-		}
+		LCD_clearScreen();
+		LCD_displayString("Wrong Password");
+		_delay_ms(500);
+		state = RE_CALL;
+		break;
+	case LOCKED_OUT:
+		state = FATAL_ERROR;
 		break;
 	}
 
 	return state;
 }
 
+/**
+ * @brief Add or remove a user of the door, or read the audit log.
+ *
+ * Called once the administrator password was checked. A new user enters a password
+ * twice, it is refused by the Control ECU if it differs from its confirmation, if it
+ * already belongs to a user or if the table is full. A user is removed by entering
+ * its password, the administrator can not be removed.
+ * The Control ECU accepts one add or remove per administrator password check, and only
+ * within APP_ADMIN_SESSION_SECONDS of it on its side.
+ */
+
+void APP_manageUsers(void) {
+	uint8 passwords[2 * PASSWORD_MAX_PACKED_SIZE] = { 0 };
+	uint8 size = 0;
+	uint8 key = 0;
+
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, "+:Add  -:Remove");
+	LCD_displayStringRowColumn(1, 0, "*:Audit Log");
+
+	do {
+		key = KEYPAD_getPressedKey();
+		_delay_ms(500); /* Press time */
+	} while (key != ADD_USER && key != REMOVE_USER && key != SHOW_AUDIT);
+
+	LCD_clearScreen();
+	if (key == SHOW_AUDIT) {
+		APP_showAuditLog();
+	} else if (key == ADD_USER) {
+		LCD_displayString("New User Pass:");
+		LCD_moveCursor(1, 0);
+		size = APP_enterPassword(&passwords[0]);
+
+		LCD_clearScreen();
+		LCD_displayStringRowColumn(0, 0, "Plz Re-Enter the");
+		LCD_displayStringRowColumn(1, 0, "same pass:");
+		size += APP_enterPassword(&passwords[size]);
+
+		APP_displayResult(APP_request(APP_USER_ADD, passwords, size),
+				"User Added", "Not Added");
+	} else {
+		LCD_displayString("User Pass:");
+		LCD_moveCursor(1, 0);
+		size = APP_enterPassword(passwords);
+
+		APP_displayResult(APP_request(APP_USER_REMOVE, passwords, size),
+				"User Removed", "Not Found");
+	}
+}
+
+/**
+ * @brief Display the link health counters of both ECUs.
+ *
+ * The Control ECU counters are read with an APP_GET_DIAGNOSTICS request, then the local
+ * HMI counters are shown. Each page stays on the LCD until a key is pressed.
+ * FE: framing errors, PE: parity errors, OV: hardware overruns plus ring buffer overflows,
+ * HW: receive/transmit ring buffer high-water marks, CRC: corrupted frames.
+ * The Control ECU receive side has no ring buffer, its OV counts the requests dropped
+ * while one was handled and its receive HW the most bytes received during one request.
+ * A last Control ECU page shows the storage operations that failed after all retries, the
+ * audit events lost and the CPU time of a password check in thousands of cycles, '!' if
+ * over APP_CHECK_BUDGET_CYCLES.
+ */
+
+void APP_showDiagnostics(void) {
+	FRAME_Type response;
+	APP_DiagnosticsType diagnostics;
+	UART_StatisticsType localStatistics;
+	uint32 checkCycles;
+
+	if (APP_exchange(APP_GET_DIAGNOSTICS, NULL_PTR, 0, &response) == SUCCESS
+			&& response.type == APP_DIAGNOSTICS
+			&& response.length == sizeof(diagnostics)) {
+		memcpy(&diagnostics, response.payload, sizeof(diagnostics));
+		APP_displayStatistics("CTRL", &diagnostics.uart, diagnostics.frame_errors);
+
+		LCD_clearScreen();
+		LCD_displayString("Errors ");
+		LCD_intgerToString(diagnostics.storage_errors);
+		LCD_displayString(" Lost ");
+		LCD_intgerToString(diagnostics.audit_dropped);
+		LCD_moveCursor(1, 0);
+		LCD_displayString("Check ");
+		/* 0xFFFF: longer than the Control ECU timer could measure */
+		checkCycles = (uint32) diagnostics.check_cycles_256 * 256;
+		LCD_intgerToString((checkCycles < 999000UL) ? (int) (checkCycles / 1000) : 999);
+		LCD_displayString("k cyc");
+		if (checkCycles > APP_CHECK_BUDGET_CYCLES) {
+			LCD_displayCharacter('!');
+		}
+		KEYPAD_getPressedKey();
+		_delay_ms(500); /* Press time */
+	} else {
+		LCD_clearScreen();
+		LCD_displayString("Link Error");
+		_delay_ms(500);
+	}
+
+	UART_getStatistics(&localStatistics);
+	APP_displayStatistics("HMI", &localStatistics, FRAME_getErrorCount());
+}
+
 /**
  * @brief Display the door state on the LCD during door unlocking.
  *
  * This function displays a message on the LCD to indicate that the door is unlocking.
  * It also utilizes a timer to control the LCD display.
+ * The Control ECU already opened the door while answering the APP_VERIFY_UNLOCK request.
  */
 
 void APP_openDoor(void) {
-	UART_sendByte(APP_OPEN_DOOR);
 	LCD_clearScreen();
 	LCD_displayStringRowColumn(0, 0, "Door is Unlocking");
 	Timer_ConfigType timerConfigData = { 0, CTC_VALUE, F_CPU_1024, CTC_MODE };
@@ -18,6 +18,8 @@
  ********************************************************************************/
 
 #include "std_types.h"
+#include "uart.h"
+#include "password.h"
 
 /*******************************************************************************
  DEFINITONS & STATIC CONFIGURATION
@@ -27,36 +29,95 @@
 #define HOLDING_TIME        5       /* Door holding state time (5*3= 15 sec) */
 #define LOCKING_TIME        6       /* Door locking state time (6*3= 18 sec) */
 #define END_TIME            11      /* End state time (11 *3 = 33 sec)*/
-#define WARNING_TIME        20      /* Warning timer duration (60 seconds) */
 
 /* Timer configurations */
 #define CTC_VALUE           23437   /* Value for Compare register (CTC) mode = 3 second */
 
 /* Application command codes */
-#define APP_SAVE_PASS       200     /* Command code for saving the password */
-#define APP_CHECK_PASS      201     /* Command code for checking the password */
+#define APP_SAVE_PASS       200     /* Command code for saving the password [password, confirmation] */
+#define APP_CHECK_PASS      201     /* Command code for checking the password [password] */
 #define APP_SEND_ERROR      202     /* Command code for sending an error */
-#define APP_OPEN_DOOR		203   	/* Request code for sending an open door message */
+#define APP_VERIFY_UNLOCK   204     /* Command code for checking the password and opening the door [password] */
+#define APP_ENTRY_START     205     /* Command code for starting a streamed password entry */
+#define APP_ENTRY_DIGIT     206     /* Command code for one streamed digit [index, digit] */
+#define APP_ENTRY_COMMIT    207     /* Command code for ending a streamed entry [request] */
+#define APP_GET_DIAGNOSTICS 208     /* Command code for reading the Control ECU link counters */
+#define APP_USER_ADD        213     /* Command code for adding a user [password, confirmation] */
+#define APP_USER_REMOVE     214     /* Command code for removing the user owning [password] */
+#define APP_GET_AUDIT       215     /* Command code for reading the audit log [uint16 first event] */
+#define APP_GET_LOCKOUT     217     /* Command code for reading the seconds left of a lockout */
+#define APP_NEEDS_SETUP     219     /* Command code for asking whether the first password is still to be set */
+#define APP_RESPONSE        210     /* Reply frame carrying the status of a request */
+#define APP_NACK            211     /* Reply frame asking to resend a corrupted request */
+#define APP_DIAGNOSTICS     212     /* Reply frame carrying an APP_DiagnosticsType */
+#define APP_AUDIT           216     /* Reply frame carrying APP_AuditEventType entries, newest first */
+#define APP_LOCKOUT         218     /* Reply frame carrying the uint16 seconds left of a lockout */
+
+/* Audit log event types, same codes as the Control ECU */
+#define AUDIT_UNLOCK            1   /* Door opened */
+#define AUDIT_FAILED_ATTEMPT    2   /* Wrong password entered */
+#define AUDIT_LOCKOUT           3   /* Too many wrong passwords, the alarm was raised */
+#define AUDIT_PASSWORD_CHANGE   4   /* Administrator password changed */
+#define AUDIT_USER_ADDED        5
+#define AUDIT_USER_REMOVED      6
+#define APP_NO_USER         0xFF    /* User field of an event without known user */
+
+/* Link retries */
+#define APP_MAX_RETRIES     3       /* Times a request is resent after a corrupted or lost exchange */
+#define APP_RESPONSE_TIMEOUT_MS 200 /* Deadline of one response, covers the slowest Control ECU request */
+#define APP_SEQ_UNNUMBERED  0       /* Number of the first request after a reset, never taken again */
 
 /* Error and success states */
 #define FATAL_ERROR         4       /* Fatal error state */
 #define RE_CALL             5       /* Request to re-enter data state */
 #define FAILED              0       /* Operation or verification failed */
 #define SUCCESS             1       /* Operation or verification successful */
+#define LINK_ERROR          6       /* No valid reply from the Control ECU */
+#define LOCKED_OUT          7       /* Password refused, the Control ECU is in a wrong password lockout */
 
-/* Password-related constants */
-#define PASSWORD_LENGTH     5       /* Length of the password */
+/* Password lengths and their packed form on the link are defined in password.h */
+
+/* Forward every digit to the Control ECU while it is typed so the verdict is
+ * ready when the Enter button is pressed, #undef it to send the whole password
+ * after the Enter button instead */
+#define APP_STREAM_DIGITS
 
 /* User choices */
 #define OPEN_DOOR           '+'     /* User chooses to open the door */
 #define CHANGE_PASS         '-'     /* User chooses to change the password */
 #define ENTER_BUTTON        '='     /* Enter button symbol */
-
-/* Maximum number of consecutive attempts */
+#define DIAGNOSTICS         '*'     /* Hidden choice, show the link health counters */
+#define MANAGE_USERS        '%'     /* User chooses to add or remove a user */
+#define ADD_USER            '+'     /* User chooses to add a user in the users menu */
+#define REMOVE_USER         '-'     /* User chooses to remove a user in the users menu */
+#define SHOW_AUDIT          '*'     /* User chooses to read the audit log in the users menu */
+
+/* Maximum number of consecutive mismatched confirmations of a new password, the wrong
+ * passwords are counted by the Control ECU which decides the lockouts */
 #define MAX_NUM_REP          3       /* Maximum number of consecutive attempts */
 
-/* Acknowledgment code */
-#define ACKNOWLEDGEMENT      2       /* Acknowledgment signal */
+/*******************************************************************************
+ TYPES DECLARATION
+ ********************************************************************************/
+
+/* Longest password check of the Control ECU shown as normal on the diagnostics screen */
+#define APP_CHECK_BUDGET_CYCLES 400000UL
+
+/* Payload of the APP_DIAGNOSTICS reply frame, same layout on both ECUs */
+typedef struct {
+	UART_StatisticsType uart; /* Control ECU UART link health counters */
+	uint16 frame_errors;      /* Corrupted request frames seen by the Control ECU */
+	uint16 storage_errors;    /* Storage reads and writes failed after all retries */
+	uint16 check_cycles_256;  /* CPU cycles of one password check / 256, measured at start up, 0xFFFF: too long */
+	uint16 audit_dropped;     /* Audit events lost because the RAM buffer of the log was full */
+} APP_DiagnosticsType;
+
+/* One event of the APP_AUDIT reply frame, same layout on both ECUs */
+typedef struct {
+	uint16 seq;               /* Event number */
+	uint8 type;               /* AUDIT_UNLOCK ... AUDIT_USER_REMOVED */
+	uint8 user;               /* User number or APP_NO_USER */
+} APP_AuditEventType;
 
 /*******************************************************************************
  FUNCTION PROTOTYPE
@@ -65,17 +126,26 @@
 /* @brief Initialize UART and LCD modules.*/
 void APP_init(void);
 
-/* @brief Send an error message and set a timer for controlling error state.*/
+/* @brief Raise the alarm and show the lockout of the Control ECU until it ends.*/
 void APP_sendError(void);
 
+/* @brief Ask the Control ECU whether the first password is still to be set.*/
+boolean APP_needsSetup(void);
+
 /* @brief Create and save a password.*/
 uint8 APP_createChangePassword(void);
 
 /* @brief Display the main options on an LCD and wait for user input.*/
 uint8 APP_displayMainOption(void);
 
-/* @brief Open the door by entering a password.*/
-uint8 APP_checkPassword(void);
+/* @brief Enter a password and send it with the given request (check or verify and unlock).*/
+uint8 APP_checkPassword(uint8 request);
+
+/* @brief Add or remove a user of the door, or read the audit log.*/
+void APP_manageUsers(void);
+
+/* @brief Display the link health counters of both ECUs.*/
+void APP_showDiagnostics(void);
 
 /* @brief Display the door state on the LCD during door unlocking.*/
 void APP_openDoor(void);
@@ -0,0 +1,46 @@
+/******************************************************************************
+ *
+ * Module: CRC
+ *
+ * File Name: crc.c
+ *
+ * Description: Source file for the CRC-16/CCITT checksum
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "crc.h"
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add one byte to a running CRC-16 and return the new CRC value.
+ * Byte-wise shift/xor form of the 0x1021 polynomial, no table is needed
+ * which keeps it small in flash and fast on an 8-bit core.
+ */
+uint16 CRC16_update(uint16 crc, uint8 data) {
+	crc = (uint8) (crc >> 8) | (crc << 8);
+	crc ^= data;
+	crc ^= (uint8) (crc & 0xFF) >> 4;
+	crc ^= (crc << 8) << 4;
+	crc ^= ((crc & 0xFF) << 4) << 1;
+	return crc;
+}
+
+/*
+ * Description :
+ * Compute the CRC-16 of a whole buffer starting from CRC16_INIT_VALUE.
+ */
+uint16 CRC16_compute(const uint8 *data, uint16 length) {
+	uint16 crc = CRC16_INIT_VALUE;
+	uint16 i;
+
+	for (i = 0; i < length; i++) {
+		crc = CRC16_update(crc, data[i]);
+	}
+	return crc;
+}
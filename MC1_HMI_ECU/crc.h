@@ -0,0 +1,41 @@
+/******************************************************************************
+ *
+ * Module: CRC
+ *
+ * File Name: crc.h
+ *
+ * Description: Header file for the CRC-16/CCITT checksum
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, no reflection */
+#define CRC16_INIT_VALUE        0xFFFF
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add one byte to a running CRC-16 and return the new CRC value.
+ */
+uint16 CRC16_update(uint16 crc, uint8 data);
+
+/*
+ * Description :
+ * Compute the CRC-16 of a whole buffer starting from CRC16_INIT_VALUE.
+ */
+uint16 CRC16_compute(const uint8 *data, uint16 length);
+
+#endif /* CRC_H_ */
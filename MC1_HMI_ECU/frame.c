@@ -0,0 +1,272 @@
+/******************************************************************************
+ *
+ * Module: Frame
+ *
+ * File Name: frame.c
+ *
+ * Description: Source file for the inter-ECU framing layer over UART
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "frame.h"
+#include "crc.h"
+#include "uart.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* Polling period of FRAME_receiveTimeout */
+#define FRAME_POLL_PERIOD_US        100
+#define FRAME_POLLS_PER_MS          (1000 / FRAME_POLL_PERIOD_US)
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+/* Parser used by the blocking FRAME_receive */
+static FRAME_ParserType g_rxParser = { FRAME_WAIT_START };
+
+/* Corrupted frames seen by all parsers, one of them may run in interrupt context */
+static volatile uint16 g_errorCount = 0;
+
+/* Sequence number of the frames sent, and where FRAME_send copies them if not NULL_PTR */
+static uint8 g_txSeq = 0;
+static FRAME_Type *g_capture = NULL_PTR;
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+/* Send the frame bytes with the CRC computed on the way */
+static void FRAME_transmit(uint8 type, uint8 seq, const uint8 *payload, uint8 length) {
+	uint16 crc = CRC16_INIT_VALUE;
+	uint8 i;
+
+	UART_sendByte(FRAME_START_BYTE);
+
+	UART_sendByte(type);
+	crc = CRC16_update(crc, type);
+
+	UART_sendByte(seq);
+	crc = CRC16_update(crc, seq);
+
+	UART_sendByte(length);
+	crc = CRC16_update(crc, length);
+
+	for (i = 0; i < length; i++) {
+		UART_sendByte(payload[i]);
+		crc = CRC16_update(crc, payload[i]);
+	}
+
+	UART_sendByte((uint8) (crc >> 8));
+	UART_sendByte((uint8) crc);
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Reset the parser so it hunts for the next start byte.
+ */
+void FRAME_parserInit(FRAME_ParserType *Parser_Ptr) {
+	Parser_Ptr->state = FRAME_WAIT_START;
+	Parser_Ptr->index = 0;
+	Parser_Ptr->crc = CRC16_INIT_VALUE;
+	Parser_Ptr->receivedCrc = 0;
+}
+
+/*
+ * Description :
+ * Feed one received byte to the streaming parser.
+ * Any byte received while waiting for the start byte is discarded, this is how
+ * the parser resynchronizes after a dropped or corrupted byte.
+ */
+FRAME_Status FRAME_parseByte(FRAME_ParserType *Parser_Ptr, uint8 data) {
+	FRAME_Status status = FRAME_INCOMPLETE;
+
+	switch (Parser_Ptr->state) {
+	case FRAME_WAIT_START:
+		if (data == FRAME_START_BYTE) {
+			FRAME_parserInit(Parser_Ptr);
+			Parser_Ptr->state = FRAME_WAIT_TYPE;
+		}
+		break;
+
+	case FRAME_WAIT_TYPE:
+		Parser_Ptr->frame.type = data;
+		Parser_Ptr->crc = CRC16_update(Parser_Ptr->crc, data);
+		Parser_Ptr->state = FRAME_WAIT_SEQ;
+		break;
+
+	case FRAME_WAIT_SEQ:
+		Parser_Ptr->frame.seq = data;
+		Parser_Ptr->crc = CRC16_update(Parser_Ptr->crc, data);
+		Parser_Ptr->state = FRAME_WAIT_LENGTH;
+		break;
+
+	case FRAME_WAIT_LENGTH:
+		if (data > FRAME_MAX_PAYLOAD) {
+			/* Can not be a valid frame, drop it and hunt for the next start byte */
+			FRAME_parserInit(Parser_Ptr);
+			g_errorCount++;
+			status = FRAME_LENGTH_ERROR;
+		} else {
+			Parser_Ptr->frame.length = data;
+			Parser_Ptr->crc = CRC16_update(Parser_Ptr->crc, data);
+			Parser_Ptr->state =
+					(data == 0) ? FRAME_WAIT_CRC_HIGH : FRAME_WAIT_PAYLOAD;
+		}
+		break;
+
+	case FRAME_WAIT_PAYLOAD:
+		Parser_Ptr->frame.payload[Parser_Ptr->index] = data;
+		Parser_Ptr->crc = CRC16_update(Parser_Ptr->crc, data);
+		Parser_Ptr->index++;
+		if (Parser_Ptr->index == Parser_Ptr->frame.length) {
+			Parser_Ptr->state = FRAME_WAIT_CRC_HIGH;
+		}
+		break;
+
+	case FRAME_WAIT_CRC_HIGH:
+		Parser_Ptr->receivedCrc = (uint16) data << 8;
+		Parser_Ptr->state = FRAME_WAIT_CRC_LOW;
+		break;
+
+	case FRAME_WAIT_CRC_LOW:
+		Parser_Ptr->receivedCrc |= data;
+		if (Parser_Ptr->receivedCrc == Parser_Ptr->crc) {
+			status = FRAME_COMPLETE;
+		} else {
+			g_errorCount++;
+			status = FRAME_CRC_ERROR;
+		}
+		Parser_Ptr->state = FRAME_WAIT_START;
+		break;
+	}
+
+	return status;
+}
+
+/*
+ * Description :
+ * Return the number of corrupted frames (CRC or length errors) seen by all parsers.
+ */
+uint16 FRAME_getErrorCount(void) {
+	uint8 sreg = SREG;
+	uint16 count;
+
+	cli();
+	count = g_errorCount;
+	SREG = sreg;
+	return count;
+}
+
+/*
+ * Description :
+ * Set the sequence number carried by the frames sent from now on.
+ */
+void FRAME_setSequence(uint8 seq) {
+	g_txSeq = seq;
+}
+
+/*
+ * Description :
+ * Keep a copy of every frame sent from now on in Frame_Ptr, NULL_PTR stops it.
+ */
+void FRAME_setCapture(FRAME_Type *Frame_Ptr) {
+	g_capture = Frame_Ptr;
+}
+
+/*
+ * Description :
+ * Build a frame around the payload and send it through the UART.
+ */
+void FRAME_send(uint8 type, const uint8 *payload, uint8 length) {
+	uint8 i;
+
+	if (g_capture != NULL_PTR) {
+		g_capture->type = type;
+		g_capture->seq = g_txSeq;
+		g_capture->length = length;
+		for (i = 0; i < length; i++) {
+			g_capture->payload[i] = payload[i];
+		}
+	}
+
+	FRAME_transmit(type, g_txSeq, payload, length);
+}
+
+/*
+ * Description :
+ * Send a frame again as it is, with its own sequence number.
+ */
+void FRAME_resend(const FRAME_Type *Frame_Ptr) {
+	FRAME_transmit(Frame_Ptr->type, Frame_Ptr->seq, Frame_Ptr->payload, Frame_Ptr->length);
+}
+
+/*
+ * Description :
+ * Block until a complete or a corrupted frame is received.
+ * Returns FRAME_COMPLETE with the frame copied to Frame_Ptr, or the error status.
+ */
+FRAME_Status FRAME_receive(FRAME_Type *Frame_Ptr) {
+	FRAME_Status status = FRAME_INCOMPLETE;
+
+	while (status == FRAME_INCOMPLETE) {
+		status = FRAME_parseByte(&g_rxParser, UART_recieveByte());
+	}
+
+	if (status == FRAME_COMPLETE) {
+		*Frame_Ptr = g_rxParser.frame;
+	}
+
+	return status;
+}
+
+/*
+ * Description :
+ * Same as FRAME_receive but give up after timeout_ms milliseconds.
+ * The deadline counts polling periods, the bytes received during a period are parsed
+ * back to back before the next one, so the deadline holds whether the peer is silent
+ * or keeps sending garbage.
+ */
+FRAME_Status FRAME_receiveTimeout(FRAME_Type *Frame_Ptr, uint16 timeout_ms) {
+	FRAME_Status status = FRAME_INCOMPLETE;
+	uint32 polls = (uint32) timeout_ms * FRAME_POLLS_PER_MS;
+	uint8 data;
+
+	while (status == FRAME_INCOMPLETE) {
+		if (UART_read(&data, 1) != 0) {
+			status = FRAME_parseByte(&g_rxParser, data);
+		} else if (polls == 0) {
+			FRAME_parserInit(&g_rxParser);
+			status = FRAME_TIMEOUT;
+		} else {
+			polls--;
+			_delay_us(FRAME_POLL_PERIOD_US);
+		}
+	}
+
+	if (status == FRAME_COMPLETE) {
+		*Frame_Ptr = g_rxParser.frame;
+	}
+
+	return status;
+}
+
+/*
+ * Description :
+ * Drop any partial frame and all the received bytes not parsed yet.
+ */
+void FRAME_flush(void) {
+	UART_flush();
+	FRAME_parserInit(&g_rxParser);
+}
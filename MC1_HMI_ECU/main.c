@@ -41,18 +41,21 @@ int main(void) {
 	/*============================================
 	 * 				Creating Password
 	 *===========================================*/
-	do {
-		/* [LOOP] Execute a loop a maximum of [MAX_NUM_REP] times,
-		 * adhering to the allowed repetition limit */
-		FuncState = APP_createChangePassword();
-		if (FuncState == FATAL_ERROR) {
-			/* [WRONG PASSWORD]
-			 * Send Error Command via UART AND Display Error Message */
-			APP_sendError();
-		} else if (FuncState == SUCCESS) {
-			break;
-		}
-	} while (FuncState == RE_CALL || FuncState == FATAL_ERROR);
+	/* Only at the first start, the Control ECU keeps the password over resets */
+	if (APP_needsSetup()) {
+		do {
+			/* [LOOP] Execute a loop a maximum of [MAX_NUM_REP] times,
+			 * adhering to the allowed repetition limit */
+			FuncState = APP_createChangePassword();
+			if (FuncState == FATAL_ERROR) {
+				/* [WRONG PASSWORD]
+				 * Send Error Command via UART AND Display Error Message */
+				APP_sendError();
+			} else if (FuncState == SUCCESS) {
+				break;
+			}
+		} while (FuncState == RE_CALL || FuncState == FATAL_ERROR);
+	}
 
 	/*============================================
 	 * 				Super Loop
@@ -71,17 +74,17 @@ int main(void) {
 			 * 				[1] Open Door
 			 *===========================================*/
 			do {
-				/* [LOOP] Execute a loop a maximum of [MAX_NUM_REP] times,
-				 * adhering to the allowed repetition limit */
-				FuncState = APP_checkPassword();
+				/* [LOOP] Execute a loop until the password is right or the
+				 * Control ECU locks the password checks out */
+				FuncState = APP_checkPassword(APP_VERIFY_UNLOCK);
 				if (FuncState == SUCCESS) {
 					/* [CORRECT PASSWORD]
-					 * Send Open Door Command via UART AND Display Door State */
+					 * The Control ECU is opening the door, Display Door State */
 					APP_openDoor();
 					break;
 				} else if (FuncState == FATAL_ERROR) {
-					/* [WRONG PASSWORD]
-					 * Send Error Command via UART AND Display Error Message */
+					/* [LOCKED OUT]
+					 * Send Error Command via UART AND Display the Lockout */
 					APP_sendError();
 					break;
 				}
@@ -94,21 +97,46 @@ int main(void) {
 			 * 				[2] Change Password
 			 *===========================================*/
 			do {
-				/* [LOOP] Execute a loop a maximum of [MAX_NUM_REP] times,
-				 * adhering to the allowed repetition limit */
+				/* [LOOP] Execute a loop until the password is right or the
+				 * Control ECU locks the password checks out */
 
-				FuncState = APP_checkPassword();
+				FuncState = APP_checkPassword(APP_CHECK_PASS);
 				if(FuncState == SUCCESS){
 				APP_createChangePassword();
 				}
 				else if (FuncState == FATAL_ERROR) {
-					/* [WRONG PASSWORD]
-					 * Send Error Command via UART AND Display Error Message */
+					/* [LOCKED OUT]
+					 * Send Error Command via UART AND Display the Lockout */
+					APP_sendError();
+					break;
+				}
+			} while (FuncState == RE_CALL);
+			break;
+
+		case MANAGE_USERS:
+			/*============================================
+			 * 				[3] Manage Users
+			 *===========================================*/
+			do {
+				/* Only the administrator password gives access to the users menu */
+				FuncState = APP_checkPassword(APP_CHECK_PASS);
+				if (FuncState == SUCCESS) {
+					APP_manageUsers();
+				} else if (FuncState == FATAL_ERROR) {
+					/* [LOCKED OUT]
+					 * Send Error Command via UART AND Display the Lockout */
 					APP_sendError();
 					break;
 				}
 			} while (FuncState == RE_CALL);
 			break;
+
+		case DIAGNOSTICS:
+			/*============================================
+			 * 				[*] Link Diagnostics
+			 *===========================================*/
+			APP_showDiagnostics();
+			break;
 			/* End of switch condition scope*/
 		}
 		/* End of super loop */
@@ -0,0 +1,58 @@
+/******************************************************************************
+ *
+ * Module: Password
+ *
+ * File Name: password.h
+ *
+ * Description: Header file for the packed password encoding shared by both ECUs
+ *
+ * Packed format:
+ * [LENGTH] [DIGIT 0 | DIGIT 1] [DIGIT 2 | DIGIT 3] ...
+ * LENGTH is the number of digits, PASSWORD_MIN_LENGTH .. PASSWORD_MAX_LENGTH, every
+ * following byte holds two digits in BCD, the first one in the high nibble. The low
+ * nibble after the last digit of an odd length is 0xF.
+ * A password has one packed form only, so the receiver can check it nibble by nibble.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef PASSWORD_H_
+#define PASSWORD_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define PASSWORD_MIN_LENGTH         4       /* Shortest password accepted by both ECUs */
+#define PASSWORD_MAX_LENGTH         16      /* Longest password, one LCD row of '*' */
+
+/* Bytes of the packed form of a password of length digits */
+#define PASSWORD_PACKED_SIZE(length)    (1 + ((length) + 1) / 2)
+#define PASSWORD_MAX_PACKED_SIZE        PASSWORD_PACKED_SIZE(PASSWORD_MAX_LENGTH)
+
+#define PASSWORD_PAD_NIBBLE         0x0F    /* Fills the last byte of an odd length */
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Pack length digits (0 .. 9 each) to packed, which must hold PASSWORD_PACKED_SIZE(length)
+ * bytes. Returns the number of bytes written, or 0 if the length or a digit is out of range.
+ */
+uint8 PASSWORD_pack(const uint8 *digits, uint8 length, uint8 *packed);
+
+/*
+ * Description :
+ * Unpack the password at the start of the size bytes of packed to digits, which must hold
+ * PASSWORD_MAX_LENGTH bytes, and its length to length_Ptr.
+ * Returns the number of bytes of its packed form, or 0 if the bytes are not a valid
+ * packed password (bad length, missing bytes, a nibble above 9 or a wrong pad nibble).
+ */
+uint8 PASSWORD_unpack(const uint8 *packed, uint8 size, uint8 *digits, uint8 *length_Ptr);
+
+#endif /* PASSWORD_H_ */
@@ -13,6 +13,130 @@
 #include "uart.h"
 #include "avr/io.h" /* To use the UART Registers */
 #include "common_macros.h" /* To use the macros like SET_BIT */
+#include <avr/interrupt.h> /* For the UART ISRs */
+#include <util/delay.h> /* For the receive timeout polling */
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#ifndef F_CPU
+#error "F_CPU must be defined to compute the UART baud rate"
+#endif
+
+/*
+ * UBRR rounded to the nearest integer in normal (U2X = 0) and double speed (U2X = 1) modes
+ * and the baud rate each one really produces.
+ */
+#define UART_UBRR_NORMAL            ((F_CPU + 8UL * UART_BAUD_RATE) / (16UL * UART_BAUD_RATE) - 1UL)
+#define UART_UBRR_DOUBLE            ((F_CPU + 4UL * UART_BAUD_RATE) / (8UL * UART_BAUD_RATE) - 1UL)
+#define UART_ACTUAL_BAUD_NORMAL     (F_CPU / (16UL * (UART_UBRR_NORMAL + 1UL)))
+#define UART_ACTUAL_BAUD_DOUBLE     (F_CPU / (8UL * (UART_UBRR_DOUBLE + 1UL)))
+
+#define UART_ABS_DIFF(A, B)         (((A) > (B)) ? ((A) - (B)) : ((B) - (A)))
+#define UART_ERROR_NORMAL           UART_ABS_DIFF(UART_ACTUAL_BAUD_NORMAL, UART_BAUD_RATE)
+#define UART_ERROR_DOUBLE           UART_ABS_DIFF(UART_ACTUAL_BAUD_DOUBLE, UART_BAUD_RATE)
+
+/*
+ * Normal mode samples every bit more times and tolerates more noise,
+ * so it is used unless double speed mode gives a smaller baud rate error.
+ */
+#if (UART_ERROR_NORMAL <= UART_ERROR_DOUBLE) && (UART_UBRR_NORMAL <= 4095UL) \
+	&& ((F_CPU / (16UL * UART_BAUD_RATE)) >= 1UL)
+#define UART_USE_2X                 0
+#define UART_UBRR_VALUE             UART_UBRR_NORMAL
+#define UART_BAUD_ERROR             UART_ERROR_NORMAL
+#else
+#define UART_USE_2X                 1
+#define UART_UBRR_VALUE             UART_UBRR_DOUBLE
+#define UART_BAUD_ERROR             UART_ERROR_DOUBLE
+#endif
+
+#if (UART_UBRR_VALUE > 4095UL) || ((F_CPU / (8UL * UART_BAUD_RATE)) < 1UL)
+#error "UART_BAUD_RATE is out of range for this F_CPU"
+#endif
+
+#if (UART_BAUD_ERROR * 100UL) > (UART_BAUD_TOLERANCE_PERCENT * UART_BAUD_RATE)
+#error "UART_BAUD_RATE can not be generated from F_CPU within UART_BAUD_TOLERANCE_PERCENT"
+#endif
+
+/* Polling period of the receive functions with timeout */
+#define UART_POLL_PERIOD_US         100
+#define UART_POLLS_PER_MS           (1000 / UART_POLL_PERIOD_US)
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+/*
+ * Ring buffers shared with the ISRs. Head and tail are free running indices,
+ * the number of stored bytes is (head - tail) and the slot is index & (SIZE - 1).
+ * Each index is written by one side only (head by the producer, tail by the consumer)
+ * and an uint8 access is atomic, so no critical section is needed.
+ */
+static volatile uint8 g_rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint8 g_rxHead = 0;
+static volatile uint8 g_rxTail = 0;
+
+static volatile uint8 g_txBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint8 g_txHead = 0;
+static volatile uint8 g_txTail = 0;
+
+/* Link health counters */
+static volatile UART_StatisticsType g_statistics;
+
+/* Optional receiver of the bytes in interrupt context, bypasses the receive ring buffer */
+static void (*volatile g_rxCallBackPtr)(uint8 data) = NULL_PTR;
+
+/*******************************************************************************
+ *                      Interrupt Service Routines                             *
+ *******************************************************************************/
+
+/* RX Complete: move the received byte from UDR to the receive ring buffer */
+ISR(USART_RXC_vect) {
+	/* The error flags belong to the byte in UDR, read them before UDR */
+	uint8 status = UCSRA;
+	uint8 data = UDR;
+	uint8 level;
+
+	g_statistics.bytes_received++;
+
+	if (BIT_IS_SET(status, DOR)) {
+		/* A byte was lost before this one, this one is still valid */
+		g_statistics.overrun_errors++;
+	}
+
+	if (BIT_IS_SET(status, FE)) {
+		g_statistics.framing_errors++;
+	} else if (BIT_IS_SET(status, PE)) {
+		g_statistics.parity_errors++;
+	} else if (g_rxCallBackPtr != NULL_PTR) {
+		g_rxCallBackPtr(data);
+	}
+	/* Drop the byte if the buffer is full, the reader is too slow */
+	else if ((uint8) (g_rxHead - g_rxTail) < UART_RX_BUFFER_SIZE) {
+		g_rxBuffer[g_rxHead & (UART_RX_BUFFER_SIZE - 1)] = data;
+		g_rxHead++;
+		level = (uint8) (g_rxHead - g_rxTail);
+		if (level > g_statistics.rx_high_water) {
+			g_statistics.rx_high_water = level;
+		}
+	} else {
+		g_statistics.buffer_overflows++;
+	}
+}
+
+/* Data Register Empty: feed UDR from the transmit ring buffer */
+ISR(USART_UDRE_vect) {
+	if (g_txHead != g_txTail) {
+		UDR = g_txBuffer[g_txTail & (UART_TX_BUFFER_SIZE - 1)];
+		g_txTail++;
+		g_statistics.bytes_sent++;
+	} else {
+		/* Nothing left to send, disable the interrupt until the next UART_write */
+		CLEAR_BIT(UCSRB, UDRIE);
+	}
+}
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -24,83 +148,172 @@
  * 1. Setup the Frame format like number of data bits, parity bit type and number of stop bits.
  * 2. Enable the UART.
  * 3. Setup the UART baud rate.
+ * 4. Enable the RX Complete interrupt to fill the receive ring buffer.
+ * All the register values are compile time constants of the static configuration.
  */
-void UART_init(const UART_ConfigType *Config_Ptr) {
-	uint16 ubrr_value = 0;
-
-	/* U2X = 1 for double transmission speed */
-	UCSRA = (1 << U2X);
+void UART_init(void) {
+	/* U2X chosen at compile time for the smallest baud rate error */
+	UCSRA = (UART_USE_2X << U2X);
 
 	/************************** UCSRB Description **************************
-	 * RXCIE = 0 Disable USART RX Complete Interrupt Enable
+	 * RXCIE = 1 Enable USART RX Complete Interrupt Enable
 	 * TXCIE = 0 Disable USART Tx Complete Interrupt Enable
-	 * UDRIE = 0 Disable USART Data Register Empty Interrupt Enable
+	 * UDRIE = 0 Disable USART Data Register Empty Interrupt Enable (set by UART_write)
 	 * RXEN  = 1 Receiver Enable
 	 * RXEN  = 1 Transmitter Enable
-	 * UCSZ2 = 0 For 8-bit data mode
+	 * UCSZ2 = bit 2 of UART_BIT_DATA, 0 For 8-bit data mode
 	 * RXB8 & TXB8 not used for 8-bit data mode
 	 ***********************************************************************/
-	UCSRB = (1 << RXEN) | (1 << TXEN);
+	g_rxHead = g_rxTail = 0;
+	g_txHead = g_txTail = 0;
+	UCSRB = (1 << RXCIE) | (1 << RXEN) | (1 << TXEN)
+			| (((UART_BIT_DATA >> 2) & 0x01) << UCSZ2);
 
 	/************************** UCSRC Description **************************
 	 * URSEL   = 1 The URSEL must be one when writing the UCSRC
 	 * UMSEL   = 0 Asynchronous Operation
-	 * UPM1:0  = 00 Disable parity bit
-	 * USBS    = 0 One stop bit
-	 * UCSZ1:0 = 11 For 8-bit data mode
+	 * UPM1:0  = UART_PARITY
+	 * USBS    = UART_STOP_BIT
+	 * UCSZ1:0 = bits 1:0 of UART_BIT_DATA, 11 For 8-bit data mode
 	 * UCPOL   = 0 Used with the Synchronous operation only
 	 ***********************************************************************/
-	UCSRC = (1 << URSEL) | (Config_Ptr->parity & 0x03 << UPM0)
-			| (Config_Ptr->stop_bit & 0x01 << USBS) | (Config_Ptr->bit_data & 0x07 << UCSZ0)
-			| (1 << UCSZ1);
-
-	/* Calculate the UBRR register value */
-	ubrr_value = (uint16) (((F_CPU / (Config_Ptr->baud_rate * 8UL))) - 1);
+	UCSRC = (1 << URSEL) | ((UART_PARITY & 0x03) << UPM0)
+			| ((UART_STOP_BIT & 0x01) << USBS) | ((UART_BIT_DATA & 0x03) << UCSZ0);
 
 	/* First 8 bits from the BAUD_PRESCALE inside UBRRL and last 4 bits in UBRRH*/
-	UBRRH = ubrr_value >> 8;
-	UBRRL = ubrr_value;
+	UBRRH = (uint8) (UART_UBRR_VALUE >> 8);
+	UBRRL = (uint8) UART_UBRR_VALUE;
 }
 
 /*
  * Description :
- * Functional responsible for send byte to another UART device.
+ * Non-blocking write, queue up to size bytes in the transmit ring buffer and
+ * let the UDRE interrupt send them. Returns the number of bytes accepted.
  */
-void UART_sendByte(const uint8 data) {
-	/*
-	 * UDRE flag is set when the Tx buffer (UDR) is empty and ready for
-	 * transmitting a new byte so wait until this flag is set to one
-	 */
-	while (BIT_IS_CLEAR(UCSRA, UDRE)) {
+uint8 UART_write(const uint8 *data, uint8 size) {
+	uint8 count = 0;
+	uint8 level;
+
+	while ((count < size)
+			&& ((uint8) (g_txHead - g_txTail) < UART_TX_BUFFER_SIZE)) {
+		g_txBuffer[g_txHead & (UART_TX_BUFFER_SIZE - 1)] = data[count];
+		g_txHead++;
+		count++;
 	}
 
-	/*
-	 * Put the required data in the UDR register and it also clear the UDRE flag as
-	 * the UDR register is not empty now
-	 */
-	UDR = data;
+	/* Only the ISR lowers the level, the value read here is not above the real maximum */
+	level = (uint8) (g_txHead - g_txTail);
+	if (level > g_statistics.tx_high_water) {
+		g_statistics.tx_high_water = level;
+	}
 
-	/************************* Another Method *************************
-	 UDR = data;
-	 while(BIT_IS_CLEAR(UCSRA,TXC)){} // Wait until the transmission is complete TXC = 1
-	 SET_BIT(UCSRA,TXC); // Clear the TXC flag
-	 *******************************************************************/
+	/* Kick the transmitter, the UDRE interrupt fires as soon as UDR is empty */
+	if (count != 0) {
+		SET_BIT(UCSRB, UDRIE);
+	}
+
+	return count;
+}
+
+/*
+ * Description :
+ * Non-blocking read, take up to size bytes already received from the receive
+ * ring buffer. Returns the number of bytes copied to data.
+ */
+uint8 UART_read(uint8 *data, uint8 size) {
+	uint8 count = 0;
+
+	while ((count < size) && (g_rxHead != g_rxTail)) {
+		data[count] = g_rxBuffer[g_rxTail & (UART_RX_BUFFER_SIZE - 1)];
+		g_rxTail++;
+		count++;
+	}
+
+	return count;
+}
+
+/*
+ * Description :
+ * Return the number of received bytes waiting in the receive ring buffer.
+ */
+uint8 UART_available(void) {
+	return (uint8) (g_rxHead - g_rxTail);
+}
+
+/*
+ * Description :
+ * Discard all the received bytes not read yet.
+ */
+void UART_flush(void) {
+	g_rxTail = g_rxHead;
+}
+
+/*
+ * Description :
+ * Take a consistent copy of the link health counters.
+ * Interrupts are disabled during the copy as the ISRs update the counters.
+ */
+void UART_getStatistics(UART_StatisticsType *Stats_Ptr) {
+	uint8 sreg = SREG;
+
+	cli();
+	*Stats_Ptr = g_statistics;
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Hand every received byte to a_ptr directly from the RX Complete interrupt
+ * instead of the receive ring buffer. Pass NULL_PTR to go back to the ring buffer.
+ */
+void UART_setRxCallBack(void (*a_ptr)(uint8 data)) {
+	g_rxCallBackPtr = a_ptr;
+}
+
+/*
+ * Description :
+ * Functional responsible for send byte to another UART device.
+ * Blocks only while the transmit ring buffer is full.
+ */
+void UART_sendByte(const uint8 data) {
+	while (UART_write(&data, 1) == 0) {
+	}
 }
 
 /*
  * Description :
  * Functional responsible for receive byte from another UART device.
+ * Blocks until a byte is available in the receive ring buffer.
  */
 uint8 UART_recieveByte(void) {
-	/* RXC flag is set when the UART receive data so wait until this flag is set to one */
-	while (BIT_IS_CLEAR(UCSRA, RXC)) {
+	uint8 data;
+
+	while (UART_read(&data, 1) == 0) {
+	}
+
+	return data;
+}
+
+/*
+ * Description :
+ * Receive one byte, waiting at most timeout_ms milliseconds for it.
+ * Returns UART_OK with the byte stored in data, or UART_TIMEOUT.
+ */
+UART_Status UART_recieveByteTimeout(uint8 *data, uint16 timeout_ms) {
+	uint16 ms;
+	uint8 poll;
+
+	for (ms = 0; ms < timeout_ms; ms++) {
+		for (poll = 0; poll < UART_POLLS_PER_MS; poll++) {
+			if (UART_read(data, 1) != 0) {
+				return UART_OK;
+			}
+			_delay_us(UART_POLL_PERIOD_US);
+		}
 	}
 
-	/*
-	 * Read the received data from the Rx buffer (UDR)
-	 * The RXC flag will be cleared after read the data
-	 */
-	return UDR;
+	/* Last chance for a byte received during the final poll period */
+	return (UART_read(data, 1) != 0) ? UART_OK : UART_TIMEOUT;
 }
 
 /*
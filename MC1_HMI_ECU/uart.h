@@ -15,6 +15,41 @@
 
 #include "std_types.h"
 
+/*******************************************************************************
+ *                      Static Configuration                                   *
+ *******************************************************************************/
+
+/*
+ * Frame format and baud rate of the inter-ECU link, both ECUs must use the same values.
+ * UBRR and U2X are computed at compile time from F_CPU and the build fails if the
+ * resulting baud rate is more than UART_BAUD_TOLERANCE_PERCENT away from UART_BAUD_RATE.
+ * At F_CPU = 8 MHz 38400 (0.2%), 250000 (exact) and 500000 (exact) baud are usable.
+ */
+#define UART_BAUD_RATE              38400UL
+#define UART_BIT_DATA               bit_8
+#define UART_PARITY                 Enabled_Even
+#define UART_STOP_BIT               bit_1
+
+#define UART_BAUD_TOLERANCE_PERCENT 2
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/*
+ * Size of the software ring buffers filled/drained by the RXC and UDRE interrupts.
+ * Must be a power of two not greater than 128 as the indices are free running uint8.
+ */
+#define UART_RX_BUFFER_SIZE         32
+#define UART_TX_BUFFER_SIZE         32
+
+#if ((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0) || (UART_RX_BUFFER_SIZE > 128)
+#error "UART_RX_BUFFER_SIZE must be a power of two not greater than 128"
+#endif
+
+#if ((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0) || (UART_TX_BUFFER_SIZE > 128)
+#error "UART_TX_BUFFER_SIZE must be a power of two not greater than 128"
+#endif
 
 /*******************************************************************************
  *                      User-Defined Types                                   *
@@ -32,14 +67,22 @@ typedef enum{
 	bit_1, bit_2
 }UART_StopBit;
 
-typedef uint16 UART_BaudRate;
+typedef enum{
+	UART_OK, UART_TIMEOUT
+}UART_Status;
 
+/* Link health counters, updated by the UART ISRs */
 typedef struct{
- UART_BitData bit_data;
- UART_Parity parity;
- UART_StopBit stop_bit;
- UART_BaudRate baud_rate;
-}UART_ConfigType;
+	uint16 framing_errors;   /* FE: stop bit not found, byte dropped */
+	uint16 overrun_errors;   /* DOR: a byte was lost in the hardware before this one */
+	uint16 parity_errors;    /* PE: parity mismatch, byte dropped */
+	uint16 buffer_overflows; /* Bytes dropped because the receive ring buffer was full */
+	uint32 bytes_received;
+	uint32 bytes_sent;
+	uint8 rx_high_water;     /* Maximum fill level of the receive ring buffer */
+	uint8 tx_high_water;     /* Maximum fill level of the transmit ring buffer */
+}UART_StatisticsType;
+
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
@@ -51,21 +94,71 @@ typedef struct{
  * 1. Setup the Frame format like number of data bits, parity bit type and number of stop bits.
  * 2. Enable the UART.
  * 3. Setup the UART baud rate.
+ * 4. Enable the RX Complete interrupt to fill the receive ring buffer.
+ * All the settings come from the static configuration above.
+ */
+void UART_init(void);
+
+/*
+ * Description :
+ * Non-blocking write, queue up to size bytes in the transmit ring buffer and
+ * let the UDRE interrupt send them. Returns the number of bytes accepted.
+ */
+uint8 UART_write(const uint8 *data, uint8 size);
+
+/*
+ * Description :
+ * Non-blocking read, take up to size bytes already received from the receive
+ * ring buffer. Returns the number of bytes copied to data.
+ */
+uint8 UART_read(uint8 *data, uint8 size);
+
+/*
+ * Description :
+ * Return the number of received bytes waiting in the receive ring buffer.
+ */
+uint8 UART_available(void);
+
+/*
+ * Description :
+ * Discard all the received bytes not read yet.
+ */
+void UART_flush(void);
+
+/*
+ * Description :
+ * Take a consistent copy of the link health counters.
  */
-void UART_init(const UART_ConfigType * Config_Ptr);
+void UART_getStatistics(UART_StatisticsType *Stats_Ptr);
+
+/*
+ * Description :
+ * Hand every received byte to a_ptr directly from the RX Complete interrupt
+ * instead of the receive ring buffer. Pass NULL_PTR to go back to the ring buffer.
+ */
+void UART_setRxCallBack(void (*a_ptr)(uint8 data));
 
 /*
  * Description :
  * Functional responsible for send byte to another UART device.
+ * Blocks only while the transmit ring buffer is full.
  */
 void UART_sendByte(const uint8 data);
 
 /*
  * Description :
  * Functional responsible for receive byte from another UART device.
+ * Blocks until a byte is available in the receive ring buffer.
  */
 uint8 UART_recieveByte(void);
 
+/*
+ * Description :
+ * Receive one byte, waiting at most timeout_ms milliseconds for it.
+ * Returns UART_OK with the byte stored in data, or UART_TIMEOUT.
+ */
+UART_Status UART_recieveByteTimeout(uint8 *data, uint16 timeout_ms);
+
 /*
  * Description :
  * Send the required string through UART to the other UART device.
@@ -5,39 +5,72 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../app.c \
+../audit.c \
+../blake2s.c \
 ../buzzer.c \
+../clock.c \
+../crc.c \
 ../dcmotor.c \
+../dispatcher.c \
 ../external_eeprom.c \
+../frame.c \
 ../gpio.c \
 ../lcd.c \
+../lockout.c \
+../logstore.c \
 ../main.c \
+../password.c \
+../persist.c \
 ../pwm_timer0.c \
+../storage.c \
 ../timer.c \
 ../twi.c \
 ../uart.c 
 
 OBJS += \
 ./app.o \
+./audit.o \
+./blake2s.o \
 ./buzzer.o \
+./clock.o \
+./crc.o \
 ./dcmotor.o \
+./dispatcher.o \
 ./external_eeprom.o \
+./frame.o \
 ./gpio.o \
 ./lcd.o \
+./lockout.o \
+./logstore.o \
 ./main.o \
+./password.o \
+./persist.o \
 ./pwm_timer0.o \
+./storage.o \
 ./timer.o \
 ./twi.o \
 ./uart.o 
 
 C_DEPS += \
 ./app.d \
+./audit.d \
+./blake2s.d \
 ./buzzer.d \
+./clock.d \
+./crc.d \
 ./dcmotor.d \
+./dispatcher.d \
 ./external_eeprom.d \
+./frame.d \
 ./gpio.d \
 ./lcd.d \
+./lockout.d \
+./logstore.d \
 ./main.d \
+./password.d \
+./persist.d \
 ./pwm_timer0.d \
+./storage.d \
 ./timer.d \
 ./twi.d \
 ./uart.d 
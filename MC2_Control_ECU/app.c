@@ -21,9 +21,76 @@
 #include "dcmotor.h"
 #include "buzzer.h"
 #include "timer.h"
-#include "external_eeprom.h"
 #include "string.h"
-#include "twi.h"
+#include "dispatcher.h"
+#include "storage.h"
+#include "logstore.h"
+#include "blake2s.h"
+#include "audit.h"
+#include "clock.h"
+#include "lockout.h"
+#include "crc.h"
+
+/*******************************************************************************
+ TYPES & GLOBAL VARIABLES
+ ********************************************************************************/
+
+/* State of a streamed password entry, digits are collected as they are typed */
+typedef struct {
+	uint8 digits[PASSWORD_MAX_LENGTH];     /* Digits received so far */
+	uint8 count;                           /* Number of digits received so far */
+	boolean spoiled;                       /* A digit was lost, the entry can not match */
+	boolean active;                        /* Set by APP_ENTRY_START, cleared by APP_ENTRY_COMMIT */
+} APP_EntrySessionType;
+
+static APP_EntrySessionType g_entrySession;
+
+/* RAM copy of the user table, loaded at APP_init and written through on every change */
+static APP_CredentialType g_users[APP_MAX_USERS];
+static boolean g_userValid[APP_MAX_USERS];
+
+/*
+ * Hashed index of the user table: open addressing with linear probing, a bucket holds
+ * the user number of a password whose hash is at or just before it. The table is never
+ * more than APP_MAX_USERS / APP_USER_INDEX_SIZE full so a lookup takes a few probes
+ * whatever the number of users.
+ */
+static uint8 g_userIndex[APP_USER_INDEX_SIZE];
+
+/*
+ * CRC16 of g_users, g_userValid and g_userIndex, updated on every change of the table.
+ * A mismatch before a lookup means the RAM copy was corrupted, it is read again.
+ */
+static uint16 g_usersCrc;
+
+/* The log store region was scanned completely, g_users is the stored user table */
+static boolean g_storeLoaded = FALSE;
+
+/*
+ * Clock second the administrator session ends, 0: no session. A session allows one
+ * change of the administrator password or of the users.
+ */
+static uint32 g_adminSessionEnd = 0;
+
+/*
+ * Clock second the buzzer of an alarm stops, 0: no alarm. The alarm is kept on the
+ * seconds clock like the lockout, TIMER1 stays with the door.
+ */
+static uint32 g_alarmEnd = 0;
+
+/* Key of the password hashes, stored with the users */
+static uint8 g_salt[APP_SALT_SIZE];
+
+/*
+ * SRAM left as it powered up, its pattern differs from chip to chip and gives the salt
+ * its only entropy (the ATmega32 has no random number generator). The salt only has
+ * to differ between locks, it is not a secret.
+ */
+static uint8 g_powerUpRam[32] __attribute__((section(".noinit")));
+
+/* Password check time measured by APP_measureCheck */
+static uint32 g_checkCycles;
+static volatile boolean g_checkOverflow;
 
 /*******************************************************************************
  CALL-BACK FUNCTIONS
@@ -55,21 +122,393 @@ static void APP_timerControlMotor(void) {
 	}
 }
 
+#if APP_SALT_KEY >= LOGSTORE_MAX_KEYS || APP_LOCKOUT_KEY >= LOGSTORE_MAX_KEYS \
+		|| APP_MAX_USERS >= APP_USER_INDEX_SIZE
+#error "APP_MAX_USERS does not fit in the log store or in the user index"
+#endif
+
+#if (APP_USER_INDEX_SIZE & (APP_USER_INDEX_SIZE - 1)) != 0
+#error "APP_USER_INDEX_SIZE must be a power of two"
+#endif
+
+#if 2 * PASSWORD_MAX_PACKED_SIZE > FRAME_MAX_PAYLOAD
+#error "A password and its confirmation must fit in one request frame"
+#endif
+
+_Static_assert(sizeof(APP_DiagnosticsType) <= FRAME_MAX_PAYLOAD,
+		"APP_DiagnosticsType must fit in one reply frame");
+
+/*******************************************************************************
+ USER TABLE
+ ********************************************************************************/
+
 /**
- * @brief Timer callback to control error state, turning off the buzzer.
+ * @brief Salted hash of a password, the only form in which a password is kept.
  *
- * This function is a timer callback that controls the error state
- * and turns off the buzzer after a specific time period (WARNING_TIME).
+ * The hash covers the length digits one byte each, the digest of a password stays the
+ * same whatever its encoding on the link and is the same size for every length.
  */
 
-static void APP_timerControlErrorState(void) {
-	static uint8 tickThreeSeconds = 0;
-	tickThreeSeconds++;
-	if (tickThreeSeconds == WARNING_TIME) {
-		BUZZER_off();
-		Timer1_deInit();
-		tickThreeSeconds = 0;
+static void APP_hashPassword(const uint8 *digits, uint8 length, uint8 *digest) {
+	BLAKE2S_compute(digest, APP_DIGEST_SIZE, g_salt, APP_SALT_SIZE, digits, length);
+}
+
+/**
+ * @brief First bucket of a password hash in the user index, the hash bits are already uniform.
+ */
+
+static uint8 APP_bucketOf(const uint8 *digest) {
+	return digest[0] & (APP_USER_INDEX_SIZE - 1);
+}
+
+/**
+ * @brief Add a valid user of the table to the user index.
+ */
+
+static void APP_indexUser(uint8 user) {
+	uint8 bucket = APP_bucketOf(g_users[user].digest);
+
+	while (g_userIndex[bucket] != APP_NO_USER) {
+		bucket = (bucket + 1) & (APP_USER_INDEX_SIZE - 1);
+	}
+	g_userIndex[bucket] = user;
+}
+
+/**
+ * @brief CRC16 of the RAM user table and its index.
+ */
+
+static uint16 APP_usersCrc(void) {
+	const uint8 *bytes = (const uint8 *) g_users;
+	uint16 crc = CRC16_INIT_VALUE;
+	uint16 i;
+
+	for (i = 0; i < sizeof(g_users); i++)
+		crc = CRC16_update(crc, bytes[i]);
+	for (i = 0; i < APP_MAX_USERS; i++)
+		crc = CRC16_update(crc, g_userValid[i]);
+	for (i = 0; i < APP_USER_INDEX_SIZE; i++)
+		crc = CRC16_update(crc, g_userIndex[i]);
+	return crc;
+}
+
+/**
+ * @brief Build the user index again from the user table and update the table CRC.
+ *
+ * Called after every change of the table, the change is then the new reference.
+ */
+
+static void APP_indexAllUsers(void) {
+	memset(g_userIndex, APP_NO_USER, sizeof(g_userIndex));
+	for (uint8 user = 0; user < APP_MAX_USERS; user++) {
+		if (g_userValid[user]) {
+			APP_indexUser(user);
+		}
+	}
+	g_usersCrc = APP_usersCrc();
+}
+
+/**
+ * @brief Read the user table from the log store, nothing is read if it could not be scanned.
+ *
+ * A user without a record that passes its CRC (blank or corrupted EEPROM) does not exist.
+ * A record still holding the password itself, as written before the passwords were
+ * hashed with APP_LEGACY_PASSWORD_LENGTH digits, is replaced by the salted hash of the password.
+ */
+
+static void APP_readUsers(void) {
+	uint8 buffer[LOGSTORE_MAX_PAYLOAD];
+	uint8 length;
+
+	for (uint8 user = 0; user < APP_MAX_USERS; user++) {
+		g_userValid[user] = FALSE;
+		if (!g_storeLoaded || LOGSTORE_read(user, buffer, &length) == ERROR) {
+			continue;
+		}
+
+		if (length == sizeof(APP_CredentialType)) {
+			memcpy(&g_users[user], buffer, sizeof(APP_CredentialType));
+			g_userValid[user] = TRUE;
+		} else if (length == APP_LEGACY_PASSWORD_LENGTH) {
+			APP_hashPassword(buffer, APP_LEGACY_PASSWORD_LENGTH, g_users[user].digest);
+			g_userValid[user] = TRUE;
+			LOGSTORE_write(user, (const uint8 *) &g_users[user], sizeof(APP_CredentialType));
+		}
+	}
+	APP_indexAllUsers();
+}
+
+/**
+ * @brief Check the RAM user table against its CRC and read it again if it was corrupted.
+ *
+ * Called before the table is used, a bit flipped in RAM can not grant or deny a password.
+ */
+
+static void APP_checkUsers(void) {
+	if (APP_usersCrc() != g_usersCrc) {
+		APP_readUsers();
+	}
+}
+
+/**
+ * @brief Find the user owning a password.
+ *
+ * The password is hashed once, then its hash is compared with the ones of its bucket
+ * in constant time: the check time does not tell how close a guess was.
+ *
+ * @return The user number, or APP_NO_USER if no user has this password.
+ */
+
+static uint8 APP_findUser(const uint8 *digits, uint8 length) {
+	uint8 digest[APP_DIGEST_SIZE];
+	uint8 bucket;
+
+	APP_checkUsers();
+	APP_hashPassword(digits, length, digest);
+	bucket = APP_bucketOf(digest);
+	while (g_userIndex[bucket] != APP_NO_USER) {
+		if (BLAKE2S_equal(g_users[g_userIndex[bucket]].digest, digest, APP_DIGEST_SIZE)) {
+			return g_userIndex[bucket];
+		}
+		bucket = (bucket + 1) & (APP_USER_INDEX_SIZE - 1);
+	}
+	return APP_NO_USER;
+}
+
+/**
+ * @brief Check a password for a request.
+ *
+ * APP_CHECK_PASS guards the administration requests and only accepts the password of
+ * APP_ADMIN_USER, APP_VERIFY_UNLOCK accepts the password of any user.
+ * A wrong password and a granted APP_VERIFY_UNLOCK are recorded in the audit log.
+ * During a lockout the password is not even hashed. The wrong password that starts a
+ * lockout raises the alarm and is answered LOCKED_OUT, so the HMI knows it at once.
+ * A granted APP_CHECK_PASS opens the administrator session, a wrong password closes it.
+ *
+ * @return SUCCESS, FAILED or LOCKED_OUT.
+ */
+
+static uint8 APP_authenticate(const uint8 *digits, uint8 length, uint8 request) {
+	uint8 user;
+
+	if (LOCKOUT_getRemaining() != 0) {
+		return LOCKED_OUT;
+	}
+
+	user = APP_findUser(digits, length);
+	if (user == APP_NO_USER || (request == APP_CHECK_PASS && user != APP_ADMIN_USER)) {
+		g_adminSessionEnd = 0;
+		AUDIT_log(AUDIT_FAILED_ATTEMPT, user);
+		if (LOCKOUT_fail()) {
+			AUDIT_log(AUDIT_LOCKOUT, APP_NO_USER);
+			APP_errorOccurred();
+			return LOCKED_OUT;
+		}
+		return FAILED;
+	}
+
+	LOCKOUT_succeed();
+	if (request == APP_VERIFY_UNLOCK) {
+		AUDIT_log(AUDIT_UNLOCK, user);
+	} else if (request == APP_CHECK_PASS) {
+		g_adminSessionEnd = CLOCK_getSeconds() + APP_ADMIN_SESSION_SECONDS;
+	}
+	return SUCCESS;
+}
+
+/**
+ * @brief Close the administrator session and tell whether it was still open.
+ *
+ * Called by APP_SAVE_PASS, APP_USER_ADD and APP_USER_REMOVE, a session allows one change
+ * whatever its result.
+ */
+
+static boolean APP_takeAdminSession(void) {
+	boolean open = (CLOCK_getSeconds() < g_adminSessionEnd);
+
+	g_adminSessionEnd = 0;
+	return open;
+}
+
+/**
+ * @brief The administrator password was never set, the table was loaded and has no administrator.
+ *
+ * A table that could not be loaded does not tell, the first password can not be set then.
+ */
+
+static boolean APP_adminMissing(void) {
+	APP_checkUsers();
+	return g_storeLoaded && !g_userValid[APP_ADMIN_USER];
+}
+
+/**
+ * @brief Load the salt, or make it on the first start.
+ */
+
+static void APP_loadSalt(void) {
+	uint8 buffer[LOGSTORE_MAX_PAYLOAD];
+	uint8 length;
+
+	if (LOGSTORE_read(APP_SALT_KEY, buffer, &length) == SUCCESS && length == APP_SALT_SIZE) {
+		memcpy(g_salt, buffer, APP_SALT_SIZE);
+		return;
+	}
+
+	BLAKE2S_compute(g_salt, APP_SALT_SIZE, NULL_PTR, 0, g_powerUpRam, sizeof(g_powerUpRam));
+	LOGSTORE_write(APP_SALT_KEY, g_salt, APP_SALT_SIZE);
+}
+
+/**
+ * @brief Load the user table from the log store into RAM and index it.
+ *
+ * After this call the stored password hashes are only read from g_users, a copy that
+ * fails its CRC is read again from the log store. If the region could not be scanned
+ * the table stays empty and g_storeLoaded is FALSE, the log store refuses every write
+ * so no stored record is overwritten. A storage that failed to initialize is not scanned.
+ */
+
+static void APP_loadUsers(uint8 storageState) {
+	LOGSTORE_ConfigType LOGSTORE_Config_Data = { APP_STORE_START_ADDRESS, APP_STORE_SLOTS };
+	uint8 state = ERROR;
+
+	/* A slot that can not be read fails the scan, the storage may answer again */
+	for (uint8 attempt = 0; storageState == SUCCESS && attempt < APP_STORE_SCAN_ATTEMPTS
+			&& state != SUCCESS; attempt++) {
+		state = LOGSTORE_init(&LOGSTORE_Config_Data);
+	}
+	g_storeLoaded = (state == SUCCESS);
+
+	APP_loadSalt();
+	APP_readUsers();
+}
+
+/**
+ * @brief Timer callback of APP_measureCheck, the check took more than the timer range.
+ */
+
+static void APP_timerCheckOverflow(void) {
+	g_checkOverflow = TRUE;
+}
+
+/**
+ * @brief Measure the CPU cycles of one password check with TIMER1.
+ *
+ * The timer counts F_CPU / 8 from 0 so it covers 524288 cycles. The result is read with
+ * APP_GET_DIAGNOSTICS to make sure a check stays under APP_CHECK_BUDGET_CYCLES, it is
+ * made with the longest password.
+ * Runs at start up, before TIMER1 is needed by the door.
+ */
+
+static void APP_measureCheck(void) {
+	Timer_ConfigType timerConfigData = { 0, 0, F_CPU_8, NORMAL_MODE };
+	uint8 password[PASSWORD_MAX_LENGTH] = { 0 };
+	uint16 count;
+
+	g_checkOverflow = FALSE;
+	Timer1_setCallBack(APP_timerCheckOverflow);
+	TIMER1_init(&timerConfigData);
+	APP_findUser(password, PASSWORD_MAX_LENGTH);
+	count = Timer1_getCount();
+	Timer1_deInit();
+	Timer1_setCallBack(NULL_PTR);
+
+	g_checkCycles = g_checkOverflow ? 0xFFFFFFFFUL : (uint32) count * 8;
+}
+
+/**
+ * @brief Set or remove (digits = NULL_PTR) a user and write it through to EEPROM.
+ *
+ * The RAM table is updated first so the change is used from the next request on.
+ * The record is appended to the log store, every change goes to the next slot of the
+ * region, and reaches the EEPROM in the background through the write-behind queue.
+ * The previous record is kept until the new one is complete, a power loss during the
+ * update leaves the old or the new password, never a mix of their digits.
+ * A removed user is stored as an empty record.
+ */
+
+static void APP_storeUser(uint8 user, const uint8 *digits, uint8 length) {
+	if (digits != NULL_PTR) {
+		APP_hashPassword(digits, length, g_users[user].digest);
+		g_userValid[user] = TRUE;
+		LOGSTORE_write(user, (const uint8 *) &g_users[user], sizeof(APP_CredentialType));
+	} else {
+		g_userValid[user] = FALSE;
+		LOGSTORE_write(user, NULL_PTR, 0);
+	}
+	APP_indexAllUsers();
+}
+
+/**
+ * @brief Unpack the count passwords that make the whole payload of a request.
+ *
+ * @return FALSE if the payload is not exactly count valid packed passwords.
+ */
+
+static boolean APP_unpackPasswords(const FRAME_Type *Request_Ptr, uint8 count,
+		uint8 digits[][PASSWORD_MAX_LENGTH], uint8 *lengths) {
+	uint8 offset = 0;
+
+	for (uint8 i = 0; i < count; i++) {
+		uint8 size = PASSWORD_unpack(&Request_Ptr->payload[offset], Request_Ptr->length - offset,
+				digits[i], &lengths[i]);
+		if (size == 0)
+			return FALSE;
+		offset += size;
 	}
+	return offset == Request_Ptr->length;
+}
+
+/*******************************************************************************
+ REQUEST HANDLERS
+ ********************************************************************************/
+
+/**
+ * @brief Handle an APP_CHECK_PASS request.
+ */
+
+static void APP_handleCheckPassword(const FRAME_Type *Request_Ptr) {
+	APP_checkPassword(Request_Ptr);
+}
+
+/**
+ * @brief Handle an APP_SEND_ERROR request by turning on the buzzer for 1 minute.
+ *
+ * A lockout already raised the alarm when it started, the HMI sends this request
+ * after it as well as after too many mismatched confirmations.
+ */
+
+static void APP_handleSendError(const FRAME_Type *Request_Ptr) {
+	APP_sendResponse(SUCCESS);
+	if (LOCKOUT_getRemaining() == 0) {
+		AUDIT_log(AUDIT_LOCKOUT, APP_NO_USER);
+		APP_errorOccurred();
+	}
+}
+
+/**
+ * @brief Handle an APP_GET_LOCKOUT request, reply with the seconds left of the lockout.
+ */
+
+static void APP_handleGetLockout(const FRAME_Type *Request_Ptr) {
+	uint16 remaining = LOCKOUT_getRemaining();
+
+	FRAME_send(APP_LOCKOUT, (const uint8 *) &remaining, sizeof(remaining));
+}
+
+/**
+ * @brief Handle an APP_NEEDS_SETUP request, SUCCESS if the first password is still to be set.
+ */
+
+static void APP_handleNeedsSetup(const FRAME_Type *Request_Ptr) {
+	APP_sendResponse(APP_adminMissing() ? SUCCESS : FAILED);
+}
+
+/**
+ * @brief Handle a request type without registered handler, let the HMI know it was not handled.
+ */
+
+static void APP_handleUnknown(const FRAME_Type *Request_Ptr) {
+	APP_sendResponse(FAILED);
 }
 
 /*******************************************************************************
@@ -79,28 +518,72 @@ static void APP_timerControlErrorState(void) {
 /**
  * @brief Initialize the application components.
  *
- * This function initializes the UART communication, TWI (I2C) communication, DC motor, and buzzer components.
- * It configures UART and TWI settings and initializes these peripherals.
- * It also performs the necessary initialization for the DC motor and buzzer.
+ * This function initializes the UART communication, the persistent storage, DC motor, and buzzer components.
+ * It configures UART and storage settings and initializes these peripherals.
+ * It also performs the necessary initialization for the DC motor and buzzer,
+ * and loads the user table into RAM once so requests never wait for the bus.
+ * A storage that fails to initialize is handled as a failed scan of the user table.
+ * The wrong password streak is loaded with them and a lockout in progress at the reset starts again.
+ * Finally it registers the handler of every request type in the dispatcher,
+ * a new request only needs a handler and one more registration here.
  */
 
 void APP_init(void) {
-	UART_ConfigType UART_Config_Data = { bit_8, Enabled_Even, bit_1, 9600 };
-	UART_init(&UART_Config_Data);
-	TWI_ConfigType TWI_Config_Data = { 400000, 1 };
-	TWI_init(&TWI_Config_Data);
+	DISPATCHER_ConfigType DISPATCHER_Config_Data = { APP_NACK, APP_handleUnknown };
+	AUDIT_ConfigType AUDIT_Config_Data = { APP_AUDIT_START_ADDRESS, APP_AUDIT_PAGES };
+	LOCKOUT_ConfigType LOCKOUT_Config_Data = { APP_LOCKOUT_KEY, APP_LOCKOUT_ATTEMPTS,
+			APP_LOCKOUT_SECONDS, APP_LOCKOUT_DOUBLINGS };
+	uint8 storageState;
+	UART_init();
+	CLOCK_init();
+	storageState = STORAGE_init();
 	DcMotor_Init();
 	BUZZER_init();
+	APP_loadUsers(storageState);
+	LOCKOUT_init(&LOCKOUT_Config_Data);
+	AUDIT_init(&AUDIT_Config_Data);
+	APP_measureCheck();
+
+	DISPATCHER_init(&DISPATCHER_Config_Data);
+	DISPATCHER_registerHandler(APP_SAVE_PASS, APP_savePassword);
+	DISPATCHER_registerHandler(APP_CHECK_PASS, APP_handleCheckPassword);
+	DISPATCHER_registerHandler(APP_VERIFY_UNLOCK, APP_verifyAndUnlock);
+	DISPATCHER_registerHandler(APP_ENTRY_START, APP_entryStart);
+	DISPATCHER_registerHandler(APP_ENTRY_DIGIT, APP_entryDigit);
+	DISPATCHER_registerHandler(APP_ENTRY_COMMIT, APP_entryCommit);
+	DISPATCHER_registerHandler(APP_GET_DIAGNOSTICS, APP_sendDiagnostics);
+	DISPATCHER_registerHandler(APP_SEND_ERROR, APP_handleSendError);
+	DISPATCHER_registerHandler(APP_USER_ADD, APP_userAdd);
+	DISPATCHER_registerHandler(APP_USER_REMOVE, APP_userRemove);
+	DISPATCHER_registerHandler(APP_GET_AUDIT, APP_sendAuditLog);
+	DISPATCHER_registerHandler(APP_GET_LOCKOUT, APP_handleGetLockout);
+	DISPATCHER_registerHandler(APP_NEEDS_SETUP, APP_handleNeedsSetup);
+}
+/**
+ * @brief Reply to the HMI with the status of the last request.
+ *
+ * Every request frame is answered with one APP_RESPONSE frame so the HMI can
+ * detect a lost or corrupted exchange and resend the request.
+ */
+
+void APP_sendResponse(uint8 status) {
+	FRAME_send(APP_RESPONSE, &status, 1);
 }
+
 /**
  * @brief Save a password in EEPROM.
  *
- * This function receives a password through UART, verifies the confirmation,
- * and writes the password to the EEPROM memory.
- * It expects to receive a password of length PASSWORD_LENGTH via UART communication.
- * Upon receiving the complete password, it stores the password in EEPROM memory.
+ * This function takes the two entered passwords from one APP_SAVE_PASS frame,
+ * verifies the confirmation, and writes the password to the credential cache and through to the EEPROM memory.
+ * The frame payload holds the first password followed by the second one, each in its packed form
+ * with its own length, so the two are also compared by length.
  * If the received passwords match, it sends an acknowledgment (SUCCESS) to the HMI microcontroller.
  * If the passwords don't match, it sends a failure code (FAILED) to the HMI microcontroller.
+ * The password set here is the one of APP_ADMIN_USER, the password of another user is refused.
+ * The first password is set freely, a change is refused (FAILED) outside the administrator
+ * session opened by the current password, so a reset of the HMI can not replace it.
+ * During a lockout the request is answered LOCKED_OUT.
+ * A frame with a wrong length or a malformed password is answered with APP_NACK so the HMI resends it.
  *
  *	[UPDATE]: Instead of receiving the one password after checking for
  *	the similarity the save in EEPROM [NOW] we receive the two entered passwords
@@ -109,90 +592,350 @@ void APP_init(void) {
  *
  */
 
-void APP_savePassword(void) {
-	uint8_t i = 0;
-	uint8_t rxFirstPassword[PASSWORD_LENGTH] = { 0 };
-	uint8_t rxSecondPassword[PASSWORD_LENGTH] = { 0 };
+void APP_savePassword(const FRAME_Type *Request_Ptr) {
+	uint8 rxPasswords[2][PASSWORD_MAX_LENGTH];
+	uint8 rxLengths[2];
 	uint8_t passwordMatch = SUCCESS;
 
-	// Notify HMI microcontroller that the password saving process is starting
-	UART_sendByte(ACKNOWLEDGEMENT);
+	if (!APP_unpackPasswords(Request_Ptr, 2, rxPasswords, rxLengths)) {
+		FRAME_send(APP_NACK, NULL_PTR, 0);
+		return;
+	}
 
-	// Receive the first part of the password
-	for (i = 0; i < PASSWORD_LENGTH; i++) {
-		rxFirstPassword[i] = UART_recieveByte();
+	// No password is looked up during a lockout
+	if (LOCKOUT_getRemaining() != 0) {
+		APP_sendResponse(LOCKED_OUT);
+		return;
 	}
 
-	// Receive the second part of the password
-	for (i = 0; i < PASSWORD_LENGTH; i++) {
-		rxSecondPassword[i] = UART_recieveByte();
+	// Only the first password is set without the current one
+	if (!APP_takeAdminSession() && !APP_adminMissing()) {
+		passwordMatch = FAILED;
 	}
 
 	// Compare the two entered passwords
-	for (i = 0; i < PASSWORD_LENGTH; i++) {
-		if (rxFirstPassword[i] != rxSecondPassword[i]) {
-			passwordMatch = FAILED;
-			break;
-		}
+	if (rxLengths[0] != rxLengths[1]
+			|| !BLAKE2S_equal(rxPasswords[0], rxPasswords[1], rxLengths[0])) {
+		passwordMatch = FAILED;
+	}
+
+	// Two users can not share a password, it identifies the user
+	uint8 owner = APP_findUser(rxPasswords[0], rxLengths[0]);
+	if (owner != APP_NO_USER && owner != APP_ADMIN_USER) {
+		passwordMatch = FAILED;
+	}
+
+	// A change that can not be stored is refused
+	if (!g_storeLoaded) {
+		passwordMatch = FAILED;
 	}
 
 	// Process based on the password matching result
 	if (passwordMatch == SUCCESS) {
 		// Send an acknowledgment of successful password storage
-		UART_sendByte(SUCCESS);
+		APP_sendResponse(SUCCESS);
 
-		// Write the password to EEPROM
-		for (uint8_t i = 0; i < PASSWORD_LENGTH; i++) {
-			EEPROM_writeByte(EEPROM_START_ADDRESS + i, rxFirstPassword[i]);
-			_delay_ms(10); // Delay to ensure EEPROM write completion
-		}
+		// Update the administrator entry of the user table and write it through to EEPROM
+		APP_storeUser(APP_ADMIN_USER, rxPasswords[0], rxLengths[0]);
+		AUDIT_log(AUDIT_PASSWORD_CHANGE, APP_ADMIN_USER);
 	} else if (passwordMatch == FAILED) {
 		// Send a failure code to indicate password mismatch
-		UART_sendByte(FAILED);
+		APP_sendResponse(FAILED);
 	}
 }
 
 /**
  * @brief Check a received password against a stored password in EEPROM.
  *
- * This function receives a password through UART and compares it to a stored password in EEPROM.
- * It expects to receive a password of length PASSWORD_LENGTH via UART communication.
- * The function reads the stored password from EEPROM and compares each character.
- * If the received password matches the stored password, it sends a SUCCESS response via UART.
- * If the passwords do not match, it sends a FAILED response via UART.
+ * This function takes the password from one APP_CHECK_PASS frame and compares it to a stored password in EEPROM.
+ * The frame payload holds one password in its packed form.
+ * The password is looked up in the hashed index of the user table in RAM, the check needs no bus
+ * traffic and takes the same time with one user or APP_MAX_USERS.
+ * If the received password is the one of APP_ADMIN_USER, it sends a SUCCESS response via UART.
+ * Otherwise, it sends a FAILED response via UART, or LOCKED_OUT during a lockout.
  *
- * @return The function returns SUCCESS if the passwords match, and FAILED if they do not.
+ * @return The function returns SUCCESS if the passwords match, FAILED or LOCKED_OUT if they do not.
  */
 
-uint8 APP_checkPassword(void) {
+uint8 APP_checkPassword(const FRAME_Type *Request_Ptr) {
+	uint8 password[1][PASSWORD_MAX_LENGTH];
+	uint8 length;
+	uint8 passwordMatch;
+
+	if (!APP_unpackPasswords(Request_Ptr, 1, password, &length)) {
+		FRAME_send(APP_NACK, NULL_PTR, 0);
+		return FAILED;
+	}
+
+	passwordMatch = APP_authenticate(password[0], length, APP_CHECK_PASS);
+
+	/* Send the result */
+	APP_sendResponse(passwordMatch);
+
+	return passwordMatch;
+}
 
-	uint8 receivedPassword[PASSWORD_LENGTH] = { 0 };
-	uint8 storedPassword[PASSWORD_LENGTH] = { 0 };
-	uint8 passwordMatch = SUCCESS;
+/**
+ * @brief Verify a received password and open the door in the same request.
+ *
+ * The password check and the door actuation are one transaction: the door is opened
+ * only by the request that carried the correct password, no authorization state is
+ * kept between requests. The result is sent before the motor starts so the HMI can
+ * update its display while the door is opening. The password of any user opens the door.
+ */
 
-	for (uint8 i = 0; i < PASSWORD_LENGTH; i++) {
-		receivedPassword[i] = UART_recieveByte();
+void APP_verifyAndUnlock(const FRAME_Type *Request_Ptr) {
+	uint8 password[1][PASSWORD_MAX_LENGTH];
+	uint8 length;
+	uint8 passwordMatch;
+
+	if (!APP_unpackPasswords(Request_Ptr, 1, password, &length)) {
+		FRAME_send(APP_NACK, NULL_PTR, 0);
+		return;
 	}
 
-	for (uint8 i = 0; i < PASSWORD_LENGTH; i++) {
-		EEPROM_readByte(EEPROM_START_ADDRESS + i, &storedPassword[i]);
+	passwordMatch = APP_authenticate(password[0], length, APP_VERIFY_UNLOCK);
+	APP_sendResponse(passwordMatch);
+
+	if (passwordMatch == SUCCESS) {
+		APP_openDoor();
 	}
+}
 
-	for (uint8 i = 0; i < PASSWORD_LENGTH; i++) {
-		if (receivedPassword[i] != storedPassword[i]) {
-			passwordMatch = FAILED; // Passwords do not match
-			break; // Exit the loop early
-		}
+/**
+ * @brief Start a streamed password entry.
+ *
+ * The HMI sends this request when the user starts typing. The digits are collected
+ * as they arrive, only one lookup in the user index is left for the moment the
+ * Enter button is pressed.
+ */
+
+void APP_entryStart(const FRAME_Type *Request_Ptr) {
+	g_entrySession.count = 0;
+	g_entrySession.spoiled = FALSE;
+	g_entrySession.active = TRUE;
+
+	APP_sendResponse(SUCCESS);
+}
+
+/**
+ * @brief Collect one streamed digit.
+ *
+ * The frame payload is [index, digit]. The reply never tells whether the digit
+ * was right. A resent digit (index already received) is acknowledged again
+ * without being counted twice, a digit out of sequence, past PASSWORD_MAX_LENGTH
+ * or above 9 spoils the entry.
+ */
+
+void APP_entryDigit(const FRAME_Type *Request_Ptr) {
+	uint8 index = Request_Ptr->payload[0];
+
+	if (Request_Ptr->length != 2) {
+		FRAME_send(APP_NACK, NULL_PTR, 0);
+		return;
 	}
 
-	/* Send the result */
-	if (passwordMatch) {
-		UART_sendByte(SUCCESS);
-	} else {
-		UART_sendByte(FAILED);
+	if (!g_entrySession.active) {
+		APP_sendResponse(FAILED);
+		return;
 	}
 
-	return passwordMatch;
+	if (index == g_entrySession.count && index < PASSWORD_MAX_LENGTH
+			&& Request_Ptr->payload[1] <= 9) {
+		g_entrySession.digits[index] = Request_Ptr->payload[1];
+		g_entrySession.count++;
+	} else if (index >= g_entrySession.count) {
+		/* A digit was lost or is not a digit, this entry can not be correct any more */
+		g_entrySession.spoiled = TRUE;
+	}
+
+	APP_sendResponse(SUCCESS);
+}
+
+/**
+ * @brief Send the verdict of a streamed entry and open the door if requested.
+ *
+ * The frame payload is the request kind, APP_CHECK_PASS or APP_VERIFY_UNLOCK, it selects
+ * the users whose password is accepted like the request of the same code. The verdict is
+ * one lookup in the user index. The length of the password is the number of digits
+ * received, an entry shorter than PASSWORD_MIN_LENGTH fails. The session is closed so
+ * the same entry can not be committed twice.
+ * Any other request kind is answered with APP_NACK. During a lockout the reply is
+ * LOCKED_OUT whatever the entry, like the requests carrying the whole password.
+ */
+
+void APP_entryCommit(const FRAME_Type *Request_Ptr) {
+	uint8 passwordMatch = FAILED;
+
+	if (Request_Ptr->length != 1 || (Request_Ptr->payload[0] != APP_CHECK_PASS
+			&& Request_Ptr->payload[0] != APP_VERIFY_UNLOCK)) {
+		FRAME_send(APP_NACK, NULL_PTR, 0);
+		return;
+	}
+
+	if (LOCKOUT_getRemaining() != 0) {
+		passwordMatch = LOCKED_OUT;
+	} else if (g_entrySession.active && g_entrySession.count >= PASSWORD_MIN_LENGTH
+			&& !g_entrySession.spoiled) {
+		passwordMatch = APP_authenticate(g_entrySession.digits, g_entrySession.count,
+				Request_Ptr->payload[0]);
+	}
+	g_entrySession.active = FALSE;
+
+	APP_sendResponse(passwordMatch);
+
+	if (passwordMatch == SUCCESS && Request_Ptr->payload[0] == APP_VERIFY_UNLOCK) {
+		APP_openDoor();
+	}
+}
+
+/**
+ * @brief Add a user to the user table.
+ *
+ * The frame payload is the new password followed by its confirmation, both packed. The HMI checks
+ * the administrator password with APP_CHECK_PASS before sending this request, the request
+ * uses up the administrator session it opened.
+ * The reply is FAILED outside an administrator session, if the two passwords differ, if the
+ * password already belongs to a user, if the table is full or could not be loaded,
+ * LOCKED_OUT during a lockout.
+ */
+
+void APP_userAdd(const FRAME_Type *Request_Ptr) {
+	uint8 passwords[2][PASSWORD_MAX_LENGTH];
+	uint8 lengths[2];
+	uint8 user;
+
+	if (!APP_unpackPasswords(Request_Ptr, 2, passwords, lengths)) {
+		FRAME_send(APP_NACK, NULL_PTR, 0);
+		return;
+	}
+
+	/* No password is looked up during a lockout */
+	if (LOCKOUT_getRemaining() != 0) {
+		APP_sendResponse(LOCKED_OUT);
+		return;
+	}
+
+	if (!APP_takeAdminSession()) {
+		APP_sendResponse(FAILED);
+		return;
+	}
+
+	if (lengths[0] != lengths[1] || memcmp(passwords[0], passwords[1], lengths[0]) != 0
+			|| APP_findUser(passwords[0], lengths[0]) != APP_NO_USER) {
+		APP_sendResponse(FAILED);
+		return;
+	}
+
+	/* The administrator entry is only set by APP_SAVE_PASS */
+	for (user = APP_ADMIN_USER + 1; user < APP_MAX_USERS; user++) {
+		if (!g_userValid[user])
+			break;
+	}
+	if (user == APP_MAX_USERS || !g_storeLoaded) {
+		APP_sendResponse(FAILED);
+		return;
+	}
+
+	APP_sendResponse(SUCCESS);
+	APP_storeUser(user, passwords[0], lengths[0]);
+	AUDIT_log(AUDIT_USER_ADDED, user);
+}
+
+/**
+ * @brief Remove the user owning the received password from the user table.
+ *
+ * The HMI checks the administrator password with APP_CHECK_PASS before sending this
+ * request, the request uses up the administrator session it opened. The reply is FAILED
+ * outside an administrator session, if no user has this password, the administrator can
+ * not be removed, or if the table could not be loaded. The reply is LOCKED_OUT during a lockout.
+ */
+
+void APP_userRemove(const FRAME_Type *Request_Ptr) {
+	uint8 password[1][PASSWORD_MAX_LENGTH];
+	uint8 length;
+	uint8 user;
+
+	if (!APP_unpackPasswords(Request_Ptr, 1, password, &length)) {
+		FRAME_send(APP_NACK, NULL_PTR, 0);
+		return;
+	}
+
+	/* No password is looked up during a lockout */
+	if (LOCKOUT_getRemaining() != 0) {
+		APP_sendResponse(LOCKED_OUT);
+		return;
+	}
+
+	if (!APP_takeAdminSession()) {
+		APP_sendResponse(FAILED);
+		return;
+	}
+
+	user = APP_findUser(password[0], length);
+	if (user == APP_NO_USER || user == APP_ADMIN_USER || !g_storeLoaded) {
+		APP_sendResponse(FAILED);
+		return;
+	}
+
+	APP_sendResponse(SUCCESS);
+	APP_storeUser(user, NULL_PTR, 0);
+	AUDIT_log(AUDIT_USER_REMOVED, user);
+}
+
+/**
+ * @brief Reply with a chunk of the audit log.
+ *
+ * The frame payload is the uint16 position of the first event to send, 0 is the newest
+ * event. The APP_AUDIT reply carries up to APP_AUDIT_EVENTS_PER_FRAME events going back
+ * in time, the HMI streams the whole log by asking again from the next position until
+ * a reply comes back empty.
+ */
+
+void APP_sendAuditLog(const FRAME_Type *Request_Ptr) {
+	AUDIT_EventType events[APP_AUDIT_EVENTS_PER_FRAME];
+	uint16 index;
+	uint8 count = 0;
+
+	if (Request_Ptr->length != sizeof(index)) {
+		FRAME_send(APP_NACK, NULL_PTR, 0);
+		return;
+	}
+	memcpy(&index, Request_Ptr->payload, sizeof(index));
+
+	while (count < APP_AUDIT_EVENTS_PER_FRAME
+			&& AUDIT_read(index + count, &events[count]) == SUCCESS) {
+		count++;
+	}
+
+	FRAME_send(APP_AUDIT, (const uint8 *) events, count * sizeof(AUDIT_EventType));
+}
+
+/**
+ * @brief Reply with the link health counters of the Control ECU.
+ *
+ * The UART error, traffic and buffer high-water counters plus the number of corrupted
+ * request frames are sent back in one APP_DIAGNOSTICS frame, used to size the buffers
+ * and the baud rate from field data.
+ * The dispatcher takes the received bytes before the UART receive ring buffer, so the
+ * overflow and high-water counters sent are the ones of its request queue: the requests
+ * dropped while one was handled and the most bytes received during one request.
+ */
+
+void APP_sendDiagnostics(const FRAME_Type *Request_Ptr) {
+	APP_DiagnosticsType diagnostics;
+	DISPATCHER_StatisticsType queue;
+
+	UART_getStatistics(&diagnostics.uart);
+	DISPATCHER_getStatistics(&queue);
+	diagnostics.uart.buffer_overflows = queue.dropped_requests;
+	diagnostics.uart.rx_high_water = queue.held_high_water;
+	diagnostics.frame_errors = FRAME_getErrorCount();
+	diagnostics.storage_errors = STORAGE_getErrorCount() + LOGSTORE_getErrorCount();
+	diagnostics.check_cycles_256 = (g_checkCycles < 0xFFFFUL * 256) ?
+			(uint16) (g_checkCycles / 256) : 0xFFFF;
+	diagnostics.audit_dropped = AUDIT_getDroppedCount();
+	FRAME_send(APP_DIAGNOSTICS, (const uint8 *) &diagnostics, sizeof(diagnostics));
 }
 
 /**
@@ -214,16 +957,27 @@ void APP_openDoor(void) {
 /**
  * @brief Handle an error occurrence and activate the buzzer.
  *
- * This function is responsible for handling an error occurrence in the system. It activates a timer
- * to control the error state and manages the activation of a buzzer. The timer callback function
- * `APP_timerControlErrorState` is used to control the error state. The buzzer is turned on to alert
- * users about the error condition.
+ * This function is responsible for handling an error occurrence in the system. The buzzer is
+ * turned on to alert users about the error condition for WARNING_TIME seconds of the seconds
+ * clock, an alarm raised while one sounds starts the time again. APP_updateAlarm turns it off,
+ * the door can be opened meanwhile without cutting the alarm short or leaving it on.
  */
 
 void APP_errorOccurred(void) {
-	Timer_ConfigType timerConfigData = { 0, CTC_VALUE, F_CPU_1024, CTC_MODE };
-	TIMER1_init(&timerConfigData);
-	Timer1_setCallBack(APP_timerControlErrorState);
+	g_alarmEnd = CLOCK_getSeconds() + WARNING_TIME;
 	BUZZER_on();
 }
 
+/**
+ * @brief Turn the buzzer off once the alarm time is over.
+ *
+ * Called from the superloop, the seconds clock interrupt wakes it up often enough.
+ */
+
+void APP_updateAlarm(void) {
+	if (g_alarmEnd != 0 && CLOCK_getSeconds() >= g_alarmEnd) {
+		g_alarmEnd = 0;
+		BUZZER_off();
+	}
+}
+
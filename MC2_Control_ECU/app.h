@@ -18,6 +18,10 @@
  ********************************************************************************/
 
 #include "std_types.h"
+#include "uart.h"
+#include "frame.h"
+#include "storage.h"
+#include "password.h"
 
 /*******************************************************************************
  DEFINITONS & STATIC CONFIGURATION
@@ -27,28 +31,98 @@
 #define HOLDING_TIME         5      /* Represents the holding state time for a specific operation */
 #define LOCKING_TIME         6      /* Represents the locking state time for a specific operation */
 #define END_TIME             11     /* Represents the end state time for a specific operation */
-#define WARNING_TIME         20     /* Time duration for a warning condition [3*20 = 60 seconds] */
+#define WARNING_TIME         60     /* Buzzer time of an alarm in seconds of the seconds clock */
 
 /* Timer configuration */
 #define CTC_VALUE            23437  /* Constant for a specific timer compare value [3 seconds real-time] */
 
 /* Application command codes */
-#define APP_SAVE_PASS        200    /* Request code for saving a password */
-#define APP_CHECK_PASS       201    /* Request code for checking a password */
+#define APP_SAVE_PASS        200    /* Request code for saving a password [password, confirmation] */
+#define APP_CHECK_PASS       201    /* Request code for checking a password [password] */
 #define APP_SEND_ERROR       202    /* Request code for sending an error message */
-#define APP_OPEN_DOOR		 203   	/* Request code for sending an open door message */
+#define APP_VERIFY_UNLOCK    204    /* Request code for checking a password and opening the door [password] */
+#define APP_ENTRY_START      205    /* Request code for starting a streamed password entry */
+#define APP_ENTRY_DIGIT      206    /* Request code for one streamed digit [index, digit] */
+#define APP_ENTRY_COMMIT     207    /* Request code for ending a streamed entry [APP_CHECK_PASS or APP_VERIFY_UNLOCK] */
+#define APP_GET_DIAGNOSTICS  208    /* Request code for reading the link health counters */
+#define APP_USER_ADD         213    /* Request code for adding a user [password, confirmation] */
+#define APP_USER_REMOVE      214    /* Request code for removing the user owning [password] */
+#define APP_GET_AUDIT        215    /* Request code for reading the audit log [uint16 first event] */
+#define APP_GET_LOCKOUT      217    /* Request code for reading the seconds left of a lockout */
+#define APP_NEEDS_SETUP      219    /* Request code for asking whether the first password is still to be set */
+#define APP_RESPONSE         210    /* Reply frame carrying the status of a request */
+#define APP_NACK             211    /* Reply frame asking to resend a corrupted request */
+#define APP_DIAGNOSTICS      212    /* Reply frame carrying an APP_DiagnosticsType */
+#define APP_AUDIT            216    /* Reply frame carrying up to APP_AUDIT_EVENTS_PER_FRAME AUDIT_EventType */
+#define APP_LOCKOUT          218    /* Reply frame carrying the uint16 seconds left of a lockout */
 /* Error and success states */
 #define FATAL_ERROR          4      /* Code indicating a fatal error condition */
 #define RE_CALL              5      /* Code indicating the need to re-call a function */
 #define FAILED               0      /* Code indicating a failed operation or condition */
 #define SUCCESS              1      /* Code indicating a successful operation or condition */
+#define LOCKED_OUT           7      /* Code indicating a password request refused during a lockout */
+
+/* Password lengths and their packed form in the requests are defined in password.h */
+#define APP_LEGACY_PASSWORD_LENGTH 5 /* Fixed length of the passwords stored before the lengths varied */
+
+/* User table, a password identifies its user */
+#define APP_MAX_USERS        50     /* Users of the door, the log store key of a user is its number */
+#define APP_ADMIN_USER       0      /* Only user allowed to change its password and manage the others */
+#define APP_NO_USER          0xFF   /* No user or empty bucket of the user index */
+#define APP_USER_INDEX_SIZE  64     /* Buckets of the hashed user index, a power of two above APP_MAX_USERS */
+
+/* Stored credentials: BLAKE2s of the password keyed with a salt made once per device */
+#define APP_DIGEST_SIZE      8      /* Bytes of the stored password hash */
+#define APP_SALT_SIZE        8
+#define APP_SALT_KEY         APP_MAX_USERS  /* Log store key of the salt, after the users */
+#define APP_STORE_SCAN_ATTEMPTS 3   /* Scans of the log store region at start up before giving up */
+#define APP_CHECK_BUDGET_CYCLES 400000UL /* Budget of a password check: 50 ms at 8 MHz */
+
+/* Wrong password lockout: 60 s after 3 wrong passwords in a row, doubled by every next one up to 2 h 8 min */
+#define APP_LOCKOUT_KEY      (APP_MAX_USERS + 1) /* Log store key of the wrong password streak */
+#define APP_LOCKOUT_ATTEMPTS 3
+#define APP_LOCKOUT_SECONDS  60
+#define APP_LOCKOUT_DOUBLINGS 7
+
+/* Administrator session, opened by the administrator password checked with APP_CHECK_PASS */
+#define APP_ADMIN_SESSION_SECONDS 60 /* Time left to send the one change the session allows */
+
+/* Storage layout, depends on the capacity of the storage backend selected in storage.h */
+#if (STORAGE_CAPACITY >= 8192)
+#define APP_AUDIT_START_ADDRESS 0x0000 /* Audit log region, 255 pages (1020 events) */
+#define APP_AUDIT_PAGES      255
+#define APP_STORE_START_ADDRESS 0x1000 /* Log store region of the user table, 64 pages */
+#define APP_STORE_SLOTS      64
+#elif (STORAGE_CAPACITY >= 2048)
+#define APP_AUDIT_START_ADDRESS 0x0000 /* Audit log region, 48 pages (192 events) */
+#define APP_AUDIT_PAGES      48
+#define APP_STORE_START_ADDRESS 0x0300 /* Log store region of the user table, 64 pages */
+#define APP_STORE_SLOTS      64
+#else
+#define APP_AUDIT_START_ADDRESS 0x0000 /* Audit log region, 11 pages (44 events) */
+#define APP_AUDIT_PAGES      11
+#define APP_STORE_START_ADDRESS 0x00B0 /* Log store region of the user table, 53 pages */
+#define APP_STORE_SLOTS      53
+#endif
+#define APP_AUDIT_EVENTS_PER_FRAME 6 /* Events of one APP_AUDIT reply, 6 * 4 bytes fit FRAME_MAX_PAYLOAD */
 
-/* Password-related constants */
-#define PASSWORD_LENGTH      5      /* Length of a password, typically 5 characters */
-#define EEPROM_START_ADDRESS 0x0311 /* Starting address in EEPROM for storing data */
+/*******************************************************************************
+ TYPES DECLARATION
+ ********************************************************************************/
 
-/* Acknowledgment code */
-#define ACKNOWLEDGEMENT      2      /* Code indicating acknowledgment or confirmation */
+/* Entry of the user table, the payload of the log store record of a user */
+typedef struct {
+	uint8 digest[APP_DIGEST_SIZE];   /* Salted hash of the password */
+} APP_CredentialType;
+
+/* Payload of the APP_DIAGNOSTICS reply frame, same layout on both ECUs */
+typedef struct {
+	UART_StatisticsType uart; /* Control ECU UART link health counters */
+	uint16 frame_errors;      /* Corrupted request frames seen by the Control ECU */
+	uint16 storage_errors;    /* Storage reads and writes failed after all retries */
+	uint16 check_cycles_256;  /* CPU cycles of one password check / 256, measured at start up, 0xFFFF: too long */
+	uint16 audit_dropped;     /* Audit events lost because the RAM buffer of the log was full */
+} APP_DiagnosticsType;
 
 /*******************************************************************************
  FUNCTION PROTOTYPE
@@ -57,11 +131,38 @@
 /* @brief Initialize the application components.*/
 void APP_init(void);
 
+/* @brief Reply to the HMI with the status of the last request.*/
+void APP_sendResponse(uint8 status);
+
 /* @brief Save a password in EEPROM.*/
-void APP_savePassword(void);
+void APP_savePassword(const FRAME_Type *Request_Ptr);
 
 /* @brief Check a received password against a stored password in EEPROM.*/
-uint8 APP_checkPassword(void);
+uint8 APP_checkPassword(const FRAME_Type *Request_Ptr);
+
+/* @brief Verify a received password and open the door in the same request.*/
+void APP_verifyAndUnlock(const FRAME_Type *Request_Ptr);
+
+/* @brief Start a streamed password entry.*/
+void APP_entryStart(const FRAME_Type *Request_Ptr);
+
+/* @brief Collect one streamed digit.*/
+void APP_entryDigit(const FRAME_Type *Request_Ptr);
+
+/* @brief Send the verdict of a streamed entry and open the door if requested.*/
+void APP_entryCommit(const FRAME_Type *Request_Ptr);
+
+/* @brief Add a user to the user table.*/
+void APP_userAdd(const FRAME_Type *Request_Ptr);
+
+/* @brief Remove the user owning the received password from the user table.*/
+void APP_userRemove(const FRAME_Type *Request_Ptr);
+
+/* @brief Reply with a chunk of the audit log.*/
+void APP_sendAuditLog(const FRAME_Type *Request_Ptr);
+
+/* @brief Reply with the link health counters of the Control ECU.*/
+void APP_sendDiagnostics(const FRAME_Type *Request_Ptr);
 
 /* @brief Open the door with motor control.*/
 void APP_openDoor(void);
@@ -69,4 +170,7 @@ void APP_openDoor(void);
 /* @brief Handle an error occurrence and activate the buzzer.*/
 void APP_errorOccurred(void);
 
+/* @brief Turn the buzzer off once the alarm time is over.*/
+void APP_updateAlarm(void);
+
 #endif /* APP_H_ */
@@ -0,0 +1,204 @@
+/******************************************************************************
+ *
+ * Module: Audit
+ *
+ * File Name: audit.c
+ *
+ * Description: Source file for the access audit log of the Control ECU
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "audit.h"
+#include <string.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define AUDIT_BUFFER_SIZE       (AUDIT_BUFFER_PAGES * AUDIT_EVENTS_PER_PAGE)
+
+/* Sequence numbers wrap around, the region holds far less than 32768 events */
+#define AUDIT_SEQ_NEWER(a, b)   ((sint16)((uint16)(a) - (uint16)(b)) > 0)
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+static AUDIT_ConfigType g_config;
+
+/*
+ * Events not written yet, oldest first. g_bufferHead only moves by whole pages so
+ * the oldest page is always contiguous in g_buffer.
+ */
+static AUDIT_EventType g_buffer[AUDIT_BUFFER_SIZE];
+static uint8 g_bufferHead = 0;
+static uint8 g_bufferCount = 0;
+
+static uint8 g_writePage = 0;           /* Page the next full page of events goes to */
+static uint8 g_storedPages = 0;         /* Pages of the region holding events */
+static uint16 g_nextSeq = 0;
+
+static boolean g_partialPending = FALSE; /* Events of a partial page not in the storage yet */
+static uint16 g_droppedCount = 0;       /* Events lost because the ring buffer was full */
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+static uint16 AUDIT_pageAddress(uint8 page) {
+	return g_config.start_address + (uint16)page * STORAGE_PAGE_SIZE;
+}
+
+/* Hand every full page of the ring buffer to the storage */
+static void AUDIT_flushPages(void) {
+	while (g_bufferCount >= AUDIT_EVENTS_PER_PAGE) {
+		if (!STORAGE_write(AUDIT_pageAddress(g_writePage),
+				(const uint8 *) &g_buffer[g_bufferHead], STORAGE_PAGE_SIZE)) {
+			return; /* Storage busy, try again with the next event */
+		}
+
+		g_bufferHead = (g_bufferHead + AUDIT_EVENTS_PER_PAGE) % AUDIT_BUFFER_SIZE;
+		g_bufferCount -= AUDIT_EVENTS_PER_PAGE;
+		g_writePage = (g_writePage + 1 == g_config.pages) ? 0 : g_writePage + 1;
+		if (g_storedPages < g_config.pages)
+			g_storedPages++;
+	}
+}
+
+/*
+ * Write the events of the page not full yet to the page they will fill, padded with
+ * erased events. The events stay in RAM and the page is written again once full.
+ * Returns FALSE if the storage can not take it right now.
+ */
+static boolean AUDIT_writePartialPage(void) {
+	AUDIT_EventType page[AUDIT_EVENTS_PER_PAGE];
+	uint8 i;
+
+	if (g_bufferCount == 0 || g_bufferCount >= AUDIT_EVENTS_PER_PAGE)
+		return g_bufferCount == 0; /* Full pages go first, AUDIT_flushPages was refused */
+
+	memset(page, 0xFF, sizeof(page));
+	for (i = 0; i < g_bufferCount; i++) {
+		page[i] = g_buffer[g_bufferHead + i];
+	}
+	if (!STORAGE_write(AUDIT_pageAddress(g_writePage), (const uint8 *) page, STORAGE_PAGE_SIZE))
+		return FALSE;
+
+	/* The oldest page of a full region is overwritten */
+	if (g_storedPages == g_config.pages)
+		g_storedPages--;
+	return TRUE;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+#if (STORAGE_PAGE_SIZE % 4) != 0
+#error "A page must hold a whole number of AUDIT_EventType"
+#endif
+
+uint8 AUDIT_init(const AUDIT_ConfigType *Config_Ptr) {
+	AUDIT_EventType event;
+	uint8 newest = 0;
+	uint16 newestSeq = 0;
+
+	if ((Config_Ptr->start_address & (STORAGE_PAGE_SIZE - 1)) != 0 || Config_Ptr->pages == 0)
+		return ERROR;
+	g_config = *Config_Ptr;
+
+	g_bufferHead = 0;
+	g_bufferCount = 0;
+	g_storedPages = 0;
+	g_partialPending = FALSE;
+	g_droppedCount = 0;
+
+	/* Pages are written in order, the first event tells the age of a page */
+	for (uint8 page = 0; page < g_config.pages; page++) {
+		if (STORAGE_read(AUDIT_pageAddress(page), (uint8 *) &event, sizeof(event)) == ERROR
+				|| event.type == AUDIT_EMPTY) {
+			continue;
+		}
+
+		if (g_storedPages == 0 || AUDIT_SEQ_NEWER(event.seq, newestSeq)) {
+			newest = page;
+			newestSeq = event.seq;
+		}
+		g_storedPages++;
+	}
+
+	if (g_storedPages == 0) {
+		g_writePage = 0;
+		g_nextSeq = 0;
+		return SUCCESS;
+	}
+
+	/* The newest page may be a partial one, its events go back to RAM until it is full */
+	while (g_bufferCount < AUDIT_EVENTS_PER_PAGE
+			&& STORAGE_read(AUDIT_pageAddress(newest) + g_bufferCount * sizeof(AUDIT_EventType),
+					(uint8 *) &g_buffer[g_bufferCount], sizeof(AUDIT_EventType)) == SUCCESS
+			&& g_buffer[g_bufferCount].type != AUDIT_EMPTY) {
+		g_bufferCount++;
+	}
+
+	if (g_bufferCount < AUDIT_EVENTS_PER_PAGE) {
+		g_writePage = newest;
+		g_storedPages--;
+		g_nextSeq = newestSeq + g_bufferCount;
+	} else {
+		g_bufferCount = 0;
+		g_writePage = (newest + 1 == g_config.pages) ? 0 : newest + 1;
+		g_nextSeq = newestSeq + AUDIT_EVENTS_PER_PAGE;
+	}
+
+	return SUCCESS;
+}
+
+void AUDIT_log(uint8 type, uint8 user) {
+	AUDIT_EventType *event;
+
+	if (g_bufferCount < AUDIT_BUFFER_SIZE) {
+		event = &g_buffer[(g_bufferHead + g_bufferCount) % AUDIT_BUFFER_SIZE];
+		event->seq = g_nextSeq++;
+		event->type = type;
+		event->user = user;
+		g_bufferCount++;
+		if (type != AUDIT_UNLOCK)
+			g_partialPending = TRUE;
+	} else if (g_droppedCount < 0xFFFF) {
+		g_droppedCount++;
+	}
+
+	AUDIT_flushPages();
+
+	/* An event that is not an unlock must survive a reset right away */
+	if (g_partialPending && AUDIT_writePartialPage())
+		g_partialPending = FALSE;
+}
+
+uint16 AUDIT_getDroppedCount(void) {
+	return g_droppedCount;
+}
+
+uint8 AUDIT_read(uint16 index, AUDIT_EventType *Event_Ptr) {
+	uint16 page;
+
+	/* Newest events are still in RAM */
+	if (index < g_bufferCount) {
+		*Event_Ptr = g_buffer[(g_bufferHead + g_bufferCount - 1 - index) % AUDIT_BUFFER_SIZE];
+		return SUCCESS;
+	}
+	index -= g_bufferCount;
+
+	/* Then the pages of the region, newest first */
+	page = index / AUDIT_EVENTS_PER_PAGE;
+	if (page >= g_storedPages)
+		return ERROR;
+	page = (g_writePage + g_config.pages - 1 - page) % g_config.pages;
+
+	return STORAGE_read(AUDIT_pageAddress(page)
+			+ (AUDIT_EVENTS_PER_PAGE - 1 - index % AUDIT_EVENTS_PER_PAGE) * sizeof(AUDIT_EventType),
+			(uint8 *) Event_Ptr, sizeof(AUDIT_EventType));
+}
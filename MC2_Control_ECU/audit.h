@@ -0,0 +1,89 @@
+/******************************************************************************
+ *
+ * Module: Audit
+ *
+ * File Name: audit.h
+ *
+ * Description: Header file for the access audit log of the Control ECU.
+ * Events are appended to a RAM ring buffer and written to a storage region one
+ * full page at a time, logging an event costs a few RAM writes on the unlock path.
+ * Any other event is written at once in the page it will fill, padded with erased
+ * events, so a reset right after a wrong password does not erase it.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef AUDIT_H_
+#define AUDIT_H_
+
+#include "std_types.h"
+#include "storage.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* Event types */
+#define AUDIT_UNLOCK            1       /* Door opened, user: the user who opened it */
+#define AUDIT_FAILED_ATTEMPT    2       /* Wrong password entered */
+#define AUDIT_LOCKOUT           3       /* Too many wrong passwords, the alarm was raised */
+#define AUDIT_PASSWORD_CHANGE   4       /* user: the user whose password changed */
+#define AUDIT_USER_ADDED        5       /* user: the new user */
+#define AUDIT_USER_REMOVED      6       /* user: the removed user */
+#define AUDIT_EMPTY             0xFF    /* Type of an erased event */
+
+#define AUDIT_EVENTS_PER_PAGE   (STORAGE_PAGE_SIZE / sizeof(AUDIT_EventType))
+#define AUDIT_BUFFER_PAGES      4       /* Pages of events the RAM ring buffer holds */
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+typedef struct{
+	uint16 seq;         /* Incremented by every event, tells the newest page at boot */
+	uint8 type;
+	uint8 user;
+}AUDIT_EventType;
+
+typedef struct{
+	uint16 start_address;   /* First byte of the region, aligned on STORAGE_PAGE_SIZE */
+	uint8 pages;            /* Region size in storage pages */
+}AUDIT_ConfigType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Scan the first event of every page of the region to find the newest page,
+ * the log goes on after it, or in it if it is not full. Returns ERROR for a bad
+ * configuration.
+ */
+uint8 AUDIT_init(const AUDIT_ConfigType *Config_Ptr);
+
+/*
+ * Description :
+ * Record an event in the RAM ring buffer. Every full page of events is handed to the
+ * storage, if it can not take it right now the page waits in RAM for the next event.
+ * An event other than AUDIT_UNLOCK also hands the partial page to the storage.
+ * If the ring buffer is full the new event is dropped and counted.
+ */
+void AUDIT_log(uint8 type, uint8 user);
+
+/*
+ * Description :
+ * Return the number of events dropped because the ring buffer was full.
+ */
+uint16 AUDIT_getDroppedCount(void);
+
+/*
+ * Description :
+ * Copy the event index positions back from the newest one (0 is the newest) to
+ * Event_Ptr, from the RAM ring buffer or from the storage region.
+ * Returns ERROR once index is past the oldest event kept.
+ */
+uint8 AUDIT_read(uint16 index, AUDIT_EventType *Event_Ptr);
+
+#endif /* AUDIT_H_ */
@@ -0,0 +1,194 @@
+/******************************************************************************
+ *
+ * Module: BLAKE2s
+ *
+ * File Name: blake2s.c
+ *
+ * Description: Source file for the BLAKE2s hash (RFC 7693) of the Control ECU
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "blake2s.h"
+#include <string.h>
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define BLAKE2S_ROUNDS          10
+
+/*
+ * Rotations by 16 and 8 are byte moves on an 8 bit core. The mask costs nothing on the
+ * target, it keeps the host build right where uint32 (unsigned long) is 64 bits wide:
+ * additions and XORs never move the bits above 31 down, only the rotation would.
+ */
+#define BLAKE2S_ROTR(x, n)      ((((x) & 0xFFFFFFFFUL) >> (n)) | ((x) << (32 - (n))))
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+static const uint32 g_iv[8] = {
+	0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL, 0xA54FF53AUL,
+	0x510E527FUL, 0x9B05688CUL, 0x1F83D9ABUL, 0x5BE0CD19UL
+};
+
+/* Message word order of every round, kept in flash to save 160 bytes of RAM */
+static const uint8 g_sigma[BLAKE2S_ROUNDS][16] PROGMEM = {
+	{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+	{ 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+	{  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+	{  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+	{  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+	{ 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+	{ 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+	{  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+	{ 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 }
+};
+
+/* State words a, b, c, d of the 8 G calls of a round: 4 columns then 4 diagonals */
+static const uint8 g_mix[8][4] PROGMEM = {
+	{ 0, 4,  8, 12 }, { 1, 5,  9, 13 }, { 2, 6, 10, 14 }, { 3, 7, 11, 15 },
+	{ 0, 5, 10, 15 }, { 1, 6, 11, 12 }, { 2, 7,  8, 13 }, { 3, 4,  9, 14 }
+};
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+/*
+ * Compress the buffer into the state. The G calls run from the two tables above
+ * instead of being unrolled: 80 calls of one G body keep the code small, the cost is
+ * a few flash reads per call.
+ */
+static void BLAKE2S_compress(BLAKE2S_ContextType *Context_Ptr, boolean last) {
+	const uint8 *block = Context_Ptr->buffer;
+	uint32 m[16];
+	uint32 v[16];
+	uint32 a, b, c, d;
+	uint8 ia, ib, ic, id;
+	uint8 round, i;
+
+	/* Message words are little endian */
+	for (i = 0; i < 16; i++, block += 4) {
+		m[i] = block[0] | ((uint32) block[1] << 8) | ((uint32) block[2] << 16) | ((uint32) block[3] << 24);
+	}
+
+	for (i = 0; i < 8; i++) {
+		v[i] = Context_Ptr->h[i];
+		v[i + 8] = g_iv[i];
+	}
+	v[12] ^= Context_Ptr->t;
+	if (last)
+		v[14] = ~v[14];
+
+	for (round = 0; round < BLAKE2S_ROUNDS; round++) {
+		for (i = 0; i < 8; i++) {
+			ia = pgm_read_byte(&g_mix[i][0]);
+			ib = pgm_read_byte(&g_mix[i][1]);
+			ic = pgm_read_byte(&g_mix[i][2]);
+			id = pgm_read_byte(&g_mix[i][3]);
+			a = v[ia];
+			b = v[ib];
+			c = v[ic];
+			d = v[id];
+
+			a += b + m[pgm_read_byte(&g_sigma[round][2 * i])];
+			d = BLAKE2S_ROTR(d ^ a, 16);
+			c += d;
+			b = BLAKE2S_ROTR(b ^ c, 12);
+			a += b + m[pgm_read_byte(&g_sigma[round][2 * i + 1])];
+			d = BLAKE2S_ROTR(d ^ a, 8);
+			c += d;
+			b = BLAKE2S_ROTR(b ^ c, 7);
+
+			v[ia] = a;
+			v[ib] = b;
+			v[ic] = c;
+			v[id] = d;
+		}
+	}
+
+	for (i = 0; i < 8; i++)
+		Context_Ptr->h[i] ^= v[i] ^ v[i + 8];
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void BLAKE2S_init(BLAKE2S_ContextType *Context_Ptr, uint8 digest_length,
+		const uint8 *key, uint8 key_length) {
+	memcpy(Context_Ptr->h, g_iv, sizeof(g_iv));
+	/* Parameter block: digest length, key length, fanout = depth = 1 */
+	Context_Ptr->h[0] ^= 0x01010000UL ^ ((uint32) key_length << 8) ^ digest_length;
+	Context_Ptr->t = 0;
+	Context_Ptr->count = 0;
+	Context_Ptr->digest_length = digest_length;
+
+	/* The key is hashed first, padded to a whole block */
+	if (key_length != 0) {
+		memset(Context_Ptr->buffer, 0, BLAKE2S_BLOCK_SIZE);
+		memcpy(Context_Ptr->buffer, key, key_length);
+		Context_Ptr->count = BLAKE2S_BLOCK_SIZE;
+	}
+}
+
+void BLAKE2S_update(BLAKE2S_ContextType *Context_Ptr, const uint8 *data, uint16 length) {
+	uint8 chunk;
+
+	while (length != 0) {
+		/* A full block is only compressed once more data follows, the last one is final */
+		if (Context_Ptr->count == BLAKE2S_BLOCK_SIZE) {
+			Context_Ptr->t += BLAKE2S_BLOCK_SIZE;
+			BLAKE2S_compress(Context_Ptr, FALSE);
+			Context_Ptr->count = 0;
+		}
+
+		chunk = BLAKE2S_BLOCK_SIZE - Context_Ptr->count;
+		if (chunk > length)
+			chunk = (uint8) length;
+		memcpy(&Context_Ptr->buffer[Context_Ptr->count], data, chunk);
+		Context_Ptr->count += chunk;
+		data += chunk;
+		length -= chunk;
+	}
+}
+
+void BLAKE2S_final(BLAKE2S_ContextType *Context_Ptr, uint8 *digest) {
+	uint32 word = 0;
+
+	Context_Ptr->t += Context_Ptr->count;
+	memset(&Context_Ptr->buffer[Context_Ptr->count], 0, BLAKE2S_BLOCK_SIZE - Context_Ptr->count);
+	BLAKE2S_compress(Context_Ptr, TRUE);
+
+	/* The state words in little endian order */
+	for (uint8 i = 0; i < Context_Ptr->digest_length; i++) {
+		if ((i & 3) == 0)
+			word = Context_Ptr->h[i >> 2];
+		digest[i] = (uint8) word;
+		word >>= 8;
+	}
+}
+
+void BLAKE2S_compute(uint8 *digest, uint8 digest_length, const uint8 *key, uint8 key_length,
+		const uint8 *data, uint16 length) {
+	BLAKE2S_ContextType context;
+
+	BLAKE2S_init(&context, digest_length, key, key_length);
+	BLAKE2S_update(&context, data, length);
+	BLAKE2S_final(&context, digest);
+}
+
+boolean BLAKE2S_equal(const uint8 *a, const uint8 *b, uint8 length) {
+	uint8 difference = 0;
+
+	/* No early exit: every byte is compared */
+	for (uint8 i = 0; i < length; i++)
+		difference |= a[i] ^ b[i];
+	return (difference == 0);
+}
@@ -0,0 +1,80 @@
+/******************************************************************************
+ *
+ * Module: BLAKE2s
+ *
+ * File Name: blake2s.h
+ *
+ * Description: Header file for the BLAKE2s hash (RFC 7693) of the Control ECU.
+ * BLAKE2s works on 32 bit words with additions, XORs and rotations only, which suits
+ * an 8 bit core better than SHA-256 (no message schedule, 10 rounds instead of 64).
+ * The keyed mode is used to salt the stored password hashes.
+ * Sized for small messages: at most 4 GB per hash (32 bit byte counter).
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef BLAKE2S_H_
+#define BLAKE2S_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define BLAKE2S_BLOCK_SIZE      64
+#define BLAKE2S_MAX_DIGEST      32
+#define BLAKE2S_MAX_KEY         32
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+typedef struct{
+	uint32 h[8];                            /* Chained state */
+	uint32 t;                               /* Bytes hashed before the buffer */
+	uint8 buffer[BLAKE2S_BLOCK_SIZE];
+	uint8 count;                            /* Bytes in buffer */
+	uint8 digest_length;
+}BLAKE2S_ContextType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start a hash of digest_length bytes (1 .. BLAKE2S_MAX_DIGEST), keyed with key_length
+ * bytes of key (0 .. BLAKE2S_MAX_KEY, key may be NULL_PTR when key_length is 0).
+ */
+void BLAKE2S_init(BLAKE2S_ContextType *Context_Ptr, uint8 digest_length,
+		const uint8 *key, uint8 key_length);
+
+/*
+ * Description :
+ * Add length bytes of data to the hash.
+ */
+void BLAKE2S_update(BLAKE2S_ContextType *Context_Ptr, const uint8 *data, uint16 length);
+
+/*
+ * Description :
+ * Finish the hash and copy the digest_length bytes of the digest to digest.
+ */
+void BLAKE2S_final(BLAKE2S_ContextType *Context_Ptr, uint8 *digest);
+
+/*
+ * Description :
+ * Hash a whole buffer in one call.
+ */
+void BLAKE2S_compute(uint8 *digest, uint8 digest_length, const uint8 *key, uint8 key_length,
+		const uint8 *data, uint16 length);
+
+/*
+ * Description :
+ * Compare two buffers in a time that does not depend on their content, to check a
+ * digest without telling how many of its first bytes are right.
+ */
+boolean BLAKE2S_equal(const uint8 *a, const uint8 *b, uint8 length);
+
+#endif /* BLAKE2S_H_ */
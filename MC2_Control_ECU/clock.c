@@ -0,0 +1,62 @@
+/******************************************************************************
+ *
+ * Module: Clock
+ *
+ * File Name: clock.c
+ *
+ * Description: Source file for the seconds clock of the Control ECU
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "clock.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#if (F_CPU / 256) % (CLOCK_COMPARE_VALUE + 1) != 0
+#error "CLOCK_COMPARE_VALUE does not divide F_CPU / 256, the clock would drift"
+#endif
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+static volatile uint8 g_ticks = 0;
+static volatile uint32 g_seconds = 0;
+
+/*******************************************************************************
+ *                      Interrupt Service Routine                              *
+ *******************************************************************************/
+
+ISR(TIMER2_COMP_vect) {
+	if (++g_ticks == CLOCK_TICKS_PER_SECOND) {
+		g_ticks = 0;
+		g_seconds++;
+	}
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void CLOCK_init(void) {
+	g_ticks = 0;
+	g_seconds = 0;
+	TCNT2 = 0;
+	OCR2 = CLOCK_COMPARE_VALUE;
+	TIMSK |= (1 << OCIE2);
+	/* CTC mode, F_CPU / 256 */
+	TCCR2 = (1 << WGM21) | (1 << CS22) | (1 << CS21);
+}
+
+uint32 CLOCK_getSeconds(void) {
+	uint32 seconds;
+	uint8 sreg = SREG;
+
+	/* The ISR changes the 4 bytes, they are read with interrupts disabled */
+	cli();
+	seconds = g_seconds;
+	SREG = sreg;
+	return seconds;
+}
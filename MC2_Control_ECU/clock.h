@@ -0,0 +1,44 @@
+/******************************************************************************
+ *
+ * Module: Clock
+ *
+ * File Name: clock.h
+ *
+ * Description: Header file for the seconds clock of the Control ECU.
+ * TIMER2 interrupts CLOCK_TICKS_PER_SECOND times a second and counts the seconds
+ * since CLOCK_init, TIMER1 stays free for the door and the buzzer.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* F_CPU / 256 / (CLOCK_COMPARE_VALUE + 1) = 125 Hz at 8 MHz */
+#define CLOCK_COMPARE_VALUE         249
+#define CLOCK_TICKS_PER_SECOND      (F_CPU / 256 / (CLOCK_COMPARE_VALUE + 1))
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start TIMER2 in CTC mode and the seconds count from 0.
+ */
+void CLOCK_init(void);
+
+/*
+ * Description :
+ * Return the seconds elapsed since CLOCK_init.
+ */
+uint32 CLOCK_getSeconds(void);
+
+#endif /* CLOCK_H_ */
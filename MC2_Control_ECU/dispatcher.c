@@ -0,0 +1,213 @@
+/******************************************************************************
+ *
+ * Module: Dispatcher
+ *
+ * File Name: dispatcher.c
+ *
+ * Description: Source file for the request dispatcher of the Control ECU
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "dispatcher.h"
+#include "uart.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+typedef struct{
+	uint8 type;
+	DISPATCHER_HandlerType handler;
+}DISPATCHER_EntryType;
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+static DISPATCHER_EntryType g_handlers[DISPATCHER_MAX_HANDLERS];
+static uint8 g_handlersCount = 0;
+static DISPATCHER_ConfigType g_config;
+
+/* Parser fed from the RX interrupt */
+static FRAME_ParserType g_parser;
+
+/*
+ * Last complete request, owned by the ISR while g_requestPending is FALSE
+ * and by DISPATCHER_dispatch while it is TRUE.
+ */
+static FRAME_Type g_request;
+static volatile boolean g_requestPending = FALSE;
+static volatile boolean g_nackPending = FALSE;
+
+/* Request queue counters, and the bytes received since the pending request was taken */
+static volatile DISPATCHER_StatisticsType g_statistics;
+static volatile uint8 g_heldBytes = 0;
+
+/*
+ * Reply sent to the last request and the type of that request. A request resent by
+ * the HMI because the reply was lost gets this reply again instead of running twice.
+ */
+static FRAME_Type g_reply;
+static uint8 g_replyRequestType;
+static boolean g_replyValid = FALSE;
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+/* UART RX call back, runs in interrupt context for every received byte */
+static void DISPATCHER_receiveByte(uint8 data) {
+	/* What a receive buffer would have to hold while the handler runs */
+	if (g_requestPending && g_heldBytes < 0xFF) {
+		g_heldBytes++;
+		if (g_heldBytes > g_statistics.held_high_water) {
+			g_statistics.held_high_water = g_heldBytes;
+		}
+	}
+
+	switch (FRAME_parseByte(&g_parser, data)) {
+	case FRAME_COMPLETE:
+		/* The HMI waits for the response before sending the next request,
+		 * a request arriving while the previous one is pending is dropped */
+		if (!g_requestPending) {
+			g_request = g_parser.frame;
+			g_requestPending = TRUE;
+			g_heldBytes = 0;
+		} else {
+			g_statistics.dropped_requests++;
+		}
+		break;
+	case FRAME_CRC_ERROR:
+	case FRAME_LENGTH_ERROR:
+		g_nackPending = TRUE;
+		break;
+	case FRAME_INCOMPLETE:
+	case FRAME_TIMEOUT:
+		break;
+	}
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Clear the registration table and take over the UART received bytes
+ * through the RX interrupt call back.
+ */
+void DISPATCHER_init(const DISPATCHER_ConfigType *Config_Ptr) {
+	g_config = *Config_Ptr;
+	g_handlersCount = 0;
+	g_requestPending = FALSE;
+	g_nackPending = FALSE;
+	g_replyValid = FALSE;
+	g_statistics.dropped_requests = 0;
+	g_statistics.held_high_water = 0;
+	FRAME_parserInit(&g_parser);
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	UART_setRxCallBack(DISPATCHER_receiveByte);
+}
+
+/*
+ * Description :
+ * Register the handler of a request type, registering the same type again
+ * replaces its handler. Returns FALSE if the registration table is full.
+ */
+boolean DISPATCHER_registerHandler(uint8 type, DISPATCHER_HandlerType handler) {
+	uint8 i;
+
+	for (i = 0; i < g_handlersCount; i++) {
+		if (g_handlers[i].type == type) {
+			g_handlers[i].handler = handler;
+			return TRUE;
+		}
+	}
+
+	if (g_handlersCount == DISPATCHER_MAX_HANDLERS) {
+		return FALSE;
+	}
+
+	g_handlers[g_handlersCount].type = type;
+	g_handlers[g_handlersCount].handler = handler;
+	g_handlersCount++;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Take a consistent copy of the request queue counters.
+ */
+void DISPATCHER_getStatistics(DISPATCHER_StatisticsType *Stats_Ptr) {
+	uint8 sreg = SREG;
+
+	cli();
+	Stats_Ptr->dropped_requests = g_statistics.dropped_requests;
+	Stats_Ptr->held_high_water = g_statistics.held_high_water;
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Run the handler of the pending request if any, otherwise put the CPU in idle
+ * sleep until the next interrupt. Called from the superloop.
+ * A request with the number and type of the last one is answered with the last reply
+ * without running its handler again.
+ */
+void DISPATCHER_dispatch(void) {
+	DISPATCHER_HandlerType handler = g_config.unknown_handler;
+	uint8 i;
+
+	if (g_requestPending) {
+		if (g_replyValid && g_request.seq != DISPATCHER_SEQ_UNNUMBERED
+				&& g_request.seq == g_reply.seq && g_request.type == g_replyRequestType) {
+			/* Same request again, its reply was lost */
+			FRAME_resend(&g_reply);
+		} else {
+			for (i = 0; i < g_handlersCount; i++) {
+				if (g_handlers[i].type == g_request.type) {
+					handler = g_handlers[i].handler;
+					break;
+				}
+			}
+
+			/* The reply carries the request number and is kept for a resent request */
+			g_reply.type = g_config.nack_type;
+			g_reply.seq = g_request.seq;
+			g_reply.length = 0;
+			g_replyRequestType = g_request.type;
+			g_replyValid = TRUE;
+			FRAME_setSequence(g_request.seq);
+			FRAME_setCapture(&g_reply);
+			if (handler != NULL_PTR) {
+				handler(&g_request);
+			}
+			FRAME_setCapture(NULL_PTR);
+		}
+
+		g_requestPending = FALSE;
+	} else if (g_nackPending) {
+		/* Corrupted request, ask the HMI to resend it */
+		g_nackPending = FALSE;
+		FRAME_send(g_config.nack_type, NULL_PTR, 0);
+	} else {
+		/*
+		 * Sleep until the next interrupt. The flags are checked again with interrupts
+		 * disabled, sei() takes effect after the next instruction so an interrupt can
+		 * not slip in between the check and sleep_cpu().
+		 */
+		cli();
+		if (!g_requestPending && !g_nackPending) {
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+		}
+		sei();
+	}
+}
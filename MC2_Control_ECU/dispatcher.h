@@ -0,0 +1,84 @@
+/******************************************************************************
+ *
+ * Module: Dispatcher
+ *
+ * File Name: dispatcher.h
+ *
+ * Description: Header file for the request dispatcher of the Control ECU.
+ * The UART RX interrupt assembles request frames, then the superloop runs the
+ * handler registered for the frame type.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef DISPATCHER_H_
+#define DISPATCHER_H_
+
+#include "std_types.h"
+#include "frame.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define DISPATCHER_MAX_HANDLERS     16  /* Size of the handlers registration table */
+
+/*
+ * Request number never taken for a resent request. The HMI numbers its first request
+ * after a reset with it, so a reply kept from before the reset is not replayed.
+ */
+#define DISPATCHER_SEQ_UNNUMBERED   0
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+typedef void (*DISPATCHER_HandlerType)(const FRAME_Type *Request_Ptr);
+
+typedef struct{
+	uint16 dropped_requests;    /* Requests received while the previous one was still handled */
+	uint8 held_high_water;      /* Most bytes received while one request was handled */
+}DISPATCHER_StatisticsType;
+
+typedef struct{
+	uint8 nack_type;                        /* Frame type sent back for a corrupted request */
+	DISPATCHER_HandlerType unknown_handler; /* Called for a type without registered handler */
+}DISPATCHER_ConfigType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Clear the registration table and take over the UART received bytes
+ * through the RX interrupt call back.
+ */
+void DISPATCHER_init(const DISPATCHER_ConfigType *Config_Ptr);
+
+/*
+ * Description :
+ * Register the handler of a request type.
+ * Returns FALSE if the registration table is full.
+ */
+boolean DISPATCHER_registerHandler(uint8 type, DISPATCHER_HandlerType handler);
+
+/*
+ * Description :
+ * Take a consistent copy of the request queue counters. The UART receive ring buffer
+ * is bypassed by the dispatcher, these counters take the place of its overflow and
+ * high-water counters.
+ */
+void DISPATCHER_getStatistics(DISPATCHER_StatisticsType *Stats_Ptr);
+
+/*
+ * Description :
+ * Run the handler of the pending request if any, otherwise put the CPU in idle
+ * sleep until the next interrupt. Called from the superloop.
+ * A request resent with the same sequence number and type as the last one gets the
+ * last reply again, its handler runs once.
+ */
+void DISPATCHER_dispatch(void);
+
+#endif /* DISPATCHER_H_ */
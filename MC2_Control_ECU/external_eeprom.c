@@ -11,24 +11,165 @@
  *******************************************************************************/
 #include "external_eeprom.h"
 #include "twi.h"
+#include <util/delay.h>
 
-uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
+/* Period of the ACK polling while the device is busy with its write cycle */
+#define EEPROM_POLL_PERIOD_US   100
+#define EEPROM_POLLS_PER_MS     (1000 / EEPROM_POLL_PERIOD_US)
+
+/* Chip holding an address of the address space and the address inside it */
+typedef struct
+{
+    const EEPROM_DeviceType *device;
+    uint16 offset;
+    uint32 left;            /* Bytes from offset to the end of the chip */
+}EEPROM_LocationType;
+
+/* Chips of the address space, the board has one 24C16 */
+static EEPROM_DeviceType g_devices[EEPROM_MAX_DEVICES] = { EEPROM_24C16 };
+static uint8 g_deviceCount = 1;
+static uint32 g_capacity = 2048;
+static uint8 g_lastWritten = EEPROM_DEVICE_ADDRESS;    /* SLA+W of the chip written last */
+
+static EEPROM_RetryPolicyType g_policy = { EEPROM_DEFAULT_ATTEMPTS, TRUE };
+static uint16 g_errorCount = 0;
+
+/* Find the chip of u16addr, ERROR if it is past the last chip */
+static uint8 EEPROM_locate(uint16 u16addr, EEPROM_LocationType *Location_Ptr)
+{
+    uint32 base = 0;
+    uint8 i;
+
+    for (i = 0; i < g_deviceCount; i++)
+    {
+        if (u16addr < base + g_devices[i].capacity)
+        {
+            Location_Ptr->device = &g_devices[i];
+            Location_Ptr->offset = (uint16)(u16addr - base);
+            Location_Ptr->left = g_devices[i].capacity - Location_Ptr->offset;
+            return SUCCESS;
+        }
+        base += g_devices[i].capacity;
+    }
+    return ERROR;
+}
+
+/* Device address, a 1 byte address chip takes the A8 A9 A10 bits in it, R/W=0 (write) */
+static uint8 EEPROM_slaW(const EEPROM_LocationType *Location_Ptr)
+{
+    if (Location_Ptr->device->address_bytes == 1)
+        return (uint8)(Location_Ptr->device->bus_address | ((Location_Ptr->offset & 0x0700) >> 7));
+    return Location_Ptr->device->bus_address;
+}
+
+/* Chip select bits of the device address taken by the A8 A9 A10 bits of a 1 byte address chip */
+static uint8 EEPROM_blockBits(const EEPROM_DeviceType *Device_Ptr)
+{
+    if (Device_Ptr->address_bytes == 1)
+        return (uint8)(((Device_Ptr->capacity - 1) >> 7) & 0x0E);
+    return 0;
+}
+
+/* ACK polling of one chip, it does not ACK its address until its write cycle is over */
+static uint8 EEPROM_poll(uint8 slaW, uint16 timeout_ms)
+{
+    uint32 polls = (uint32)timeout_ms * EEPROM_POLLS_PER_MS;
+    uint8 status;
+
+    /* The polling functions can not share the bus with the interrupt driven engine */
+    TWI_waitIdle();
+
+    do
+    {
+        TWI_start();
+        status = TWI_getStatus();
+        if (status == TWI_START || status == TWI_REP_START)
+        {
+            TWI_writeByte(slaW);
+            status = TWI_getStatus();
+        }
+        TWI_stop();
+
+        if (status == TWI_MT_SLA_W_ACK)
+            return SUCCESS;
+
+        _delay_us(EEPROM_POLL_PERIOD_US);
+    } while (polls-- != 0);
+
+    return ERROR;
+}
+
+/* Clean up after a failed attempt on Location_Ptr so the next one starts on an idle bus */
+static void EEPROM_recover(const EEPROM_LocationType *Location_Ptr)
+{
+    uint8 status = TWI_getStatus();
+
+    TWI_stop();
+    if ((status == TWI_TIMEOUT || status == TWI_BUS_FAULT || status == TWI_ARB_LOST)
+            && g_policy.recover_bus)
+    {
+        /* Nobody answers or the bus is held: clock out a stuck slave */
+        TWI_recoverBus();
+    }
+    else if (status == TWI_MT_SLA_W_NACK || status == TWI_MT_SLA_R_NACK)
+    {
+        /* The device is busy with a write cycle, wait for this one, not the last written */
+        EEPROM_poll(EEPROM_slaW(Location_Ptr), EEPROM_READY_TIMEOUT_MS);
+    }
+}
+
+/* Send the Start Bit, the device address (R/W=0) and the memory location address */
+static uint8 EEPROM_sendAddress(const EEPROM_LocationType *Location_Ptr)
 {
-	/* Send the Start Bit */
     TWI_start();
     if (TWI_getStatus() != TWI_START)
         return ERROR;
-		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=0 (write) */
-    TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700)>>7)));
+
+    TWI_writeByte(EEPROM_slaW(Location_Ptr));
     if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-        return ERROR; 
-		 
-    /* Send the required memory location address */
-    TWI_writeByte((uint8)(u16addr));
+        return ERROR;
+
+    /* High byte first on the 2 bytes address chips */
+    if (Location_Ptr->device->address_bytes == 2)
+    {
+        TWI_writeByte((uint8)(Location_Ptr->offset >> 8));
+        if (TWI_getStatus() != TWI_MT_DATA_ACK)
+            return ERROR;
+    }
+
+    TWI_writeByte((uint8)(Location_Ptr->offset));
     if (TWI_getStatus() != TWI_MT_DATA_ACK)
         return ERROR;
+
+    return SUCCESS;
+}
+
+/* Fill the addressing part of an engine transaction */
+static void EEPROM_setupTransaction(TWI_TransactionType *Transaction_Ptr, const EEPROM_LocationType *Location_Ptr)
+{
+    Transaction_Ptr->slave_address = EEPROM_slaW(Location_Ptr);
+    if (Location_Ptr->device->address_bytes == 2)
+    {
+        Transaction_Ptr->header[0] = (uint8)(Location_Ptr->offset >> 8);
+        Transaction_Ptr->header[1] = (uint8)(Location_Ptr->offset);
+        Transaction_Ptr->header_length = 2;
+    }
+    else
+    {
+        Transaction_Ptr->header[0] = (uint8)(Location_Ptr->offset);
+        Transaction_Ptr->header_length = 1;
+    }
+    Transaction_Ptr->tx_data = NULL_PTR;
+    Transaction_Ptr->tx_length = 0;
+    Transaction_Ptr->rx_data = NULL_PTR;
+    Transaction_Ptr->rx_length = 0;
+}
+
+/* One attempt of EEPROM_writeByte, without waiting for the write cycle */
+static uint8 EEPROM_writeByteOnce(const EEPROM_LocationType *Location_Ptr, uint8 u8data)
+{
+    if (EEPROM_sendAddress(Location_Ptr) == ERROR)
+        return ERROR;
 		
     /* write byte to eeprom */
     TWI_writeByte(u8data);
@@ -41,22 +182,11 @@ uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
     return SUCCESS;
 }
 
-uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
+/* One attempt of EEPROM_readByte */
+static uint8 EEPROM_readByteOnce(const EEPROM_LocationType *Location_Ptr, uint8 *u8data)
 {
-	/* Send the Start Bit */
-    TWI_start();
-    if (TWI_getStatus() != TWI_START)
-        return ERROR;
-		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=0 (write) */
-    TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-        return ERROR;
-		
-    /* Send the required memory location address */
-    TWI_writeByte((uint8)(u16addr));
-    if (TWI_getStatus() != TWI_MT_DATA_ACK)
+    /* Dummy write of the memory location address */
+    if (EEPROM_sendAddress(Location_Ptr) == ERROR)
         return ERROR;
 		
     /* Send the Repeated Start Bit */
@@ -64,9 +194,8 @@ uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
     if (TWI_getStatus() != TWI_REP_START)
         return ERROR;
 		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=1 (Read) */
-    TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7) | 1));
+    /* Send the device address with R/W=1 (Read) */
+    TWI_writeByte(EEPROM_slaW(Location_Ptr) | 1);
     if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
         return ERROR;
 
@@ -80,3 +209,298 @@ uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
 
     return SUCCESS;
 }
+
+/* Write up to one page, the bytes must not cross a page boundary of the chip */
+static uint8 EEPROM_writePage(const EEPROM_LocationType *Location_Ptr, const uint8 *data, uint8 length)
+{
+    uint8 i;
+
+    /* The device increments the memory location address inside the page */
+    if (EEPROM_sendAddress(Location_Ptr) == ERROR)
+        return ERROR;
+
+    for (i = 0; i < length; i++)
+    {
+        TWI_writeByte(data[i]);
+        if (TWI_getStatus() != TWI_MT_DATA_ACK)
+            return ERROR;
+    }
+
+    /* Send the Stop Bit, the internal write cycle of the whole page starts now */
+    TWI_stop();
+
+    return SUCCESS;
+}
+
+/* One attempt of a sequential read inside one chip, length must not be 0 */
+static uint8 EEPROM_readBlockOnce(const EEPROM_LocationType *Location_Ptr, uint8 *data, uint16 length)
+{
+    uint16 i;
+
+    /* Dummy write of the first memory location address */
+    if (EEPROM_sendAddress(Location_Ptr) == ERROR)
+        return ERROR;
+
+    /* Send the Repeated Start Bit */
+    TWI_start();
+    if (TWI_getStatus() != TWI_REP_START)
+        return ERROR;
+
+    /* Send the device address with R/W=1 (Read) */
+    TWI_writeByte(EEPROM_slaW(Location_Ptr) | 1);
+    if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
+        return ERROR;
+
+    /* The device increments its address counter after every byte, ACK asks for the next one */
+    for (i = 0; i < length - 1; i++)
+    {
+        data[i] = TWI_readByteWithACK();
+        if (TWI_getStatus() != TWI_MR_DATA_ACK)
+            return ERROR;
+    }
+
+    /* NACK the last byte to end the burst */
+    data[i] = TWI_readByteWithNACK();
+    if (TWI_getStatus() != TWI_MR_DATA_NACK)
+        return ERROR;
+
+    /* Send the Stop Bit */
+    TWI_stop();
+
+    return SUCCESS;
+}
+
+uint8 EEPROM_init(const EEPROM_ConfigType *Config_Ptr)
+{
+    const EEPROM_DeviceType *device;
+    uint32 capacity = 0;
+    uint8 shared;
+    uint8 i;
+    uint8 j;
+
+    if (Config_Ptr->device_count == 0 || Config_Ptr->device_count > EEPROM_MAX_DEVICES)
+        return ERROR;
+
+    for (i = 0; i < Config_Ptr->device_count; i++)
+    {
+        device = &Config_Ptr->devices[i];
+        if ((device->bus_address & 0xF1) != EEPROM_DEVICE_ADDRESS
+                || (device->address_bytes != 1 && device->address_bytes != 2)
+                || (device->address_bytes == 1 && device->capacity > 2048)
+                || device->page_size < EEPROM_PAGE_SIZE
+                || (device->page_size & (device->page_size - 1)) != 0
+                || device->capacity == 0
+                || (device->capacity & (device->page_size - 1)) != 0)
+        {
+            return ERROR;
+        }
+        capacity += device->capacity;
+
+        /* Two chips answering the same device address would both take the transfers */
+        for (j = 0; j < i; j++)
+        {
+            shared = EEPROM_blockBits(device) | EEPROM_blockBits(&Config_Ptr->devices[j]);
+            if ((device->bus_address & ~shared) == (Config_Ptr->devices[j].bus_address & ~shared))
+                return ERROR;
+        }
+    }
+    if (capacity > 65536UL)
+        return ERROR;
+
+    for (i = 0; i < Config_Ptr->device_count; i++)
+    {
+        g_devices[i] = Config_Ptr->devices[i];
+    }
+    g_deviceCount = Config_Ptr->device_count;
+    g_capacity = capacity;
+    g_lastWritten = g_devices[0].bus_address;
+
+    return SUCCESS;
+}
+
+uint32 EEPROM_getCapacity(void)
+{
+    return g_capacity;
+}
+
+uint8 EEPROM_waitReady(uint16 timeout_ms)
+{
+    return EEPROM_poll(g_lastWritten, timeout_ms);
+}
+
+uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
+{
+    EEPROM_LocationType location;
+    uint8 attempt;
+
+    if (EEPROM_locate(u16addr, &location) == ERROR)
+        return ERROR;
+
+    /* The polling functions can not share the bus with the interrupt driven engine */
+    TWI_waitIdle();
+
+    for (attempt = 0; attempt < g_policy.attempts; attempt++)
+    {
+        if (EEPROM_writeByteOnce(&location, u8data) == SUCCESS)
+        {
+            /* Return once the internal write cycle is over */
+            g_lastWritten = EEPROM_slaW(&location);
+            return EEPROM_waitReady(EEPROM_READY_TIMEOUT_MS);
+        }
+        EEPROM_recover(&location);
+    }
+
+    g_errorCount++;
+    return ERROR;
+}
+
+uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
+{
+    EEPROM_LocationType location;
+    uint8 attempt;
+
+    if (EEPROM_locate(u16addr, &location) == ERROR)
+        return ERROR;
+
+    /* The polling functions can not share the bus with the interrupt driven engine */
+    TWI_waitIdle();
+
+    for (attempt = 0; attempt < g_policy.attempts; attempt++)
+    {
+        if (EEPROM_readByteOnce(&location, u8data) == SUCCESS)
+            return SUCCESS;
+        EEPROM_recover(&location);
+    }
+
+    g_errorCount++;
+    return ERROR;
+}
+
+uint8 EEPROM_writeBlock(uint16 u16addr, const uint8 *data, uint16 length)
+{
+    EEPROM_LocationType location;
+    uint8 pageSize;
+    uint8 chunk;
+    uint8 attempt;
+
+    if ((uint32)u16addr + length > g_capacity)
+        return ERROR;
+
+    /* The polling functions can not share the bus with the interrupt driven engine */
+    TWI_waitIdle();
+
+    while (length != 0)
+    {
+        /* Bytes left until the end of the current page, a page never crosses a chip */
+        EEPROM_locate(u16addr, &location);
+        pageSize = location.device->page_size;
+        chunk = pageSize - (location.offset & (pageSize - 1));
+        if (chunk > length)
+            chunk = (uint8)length;
+
+        for (attempt = 0; attempt < g_policy.attempts; attempt++)
+        {
+            if (EEPROM_writePage(&location, data, chunk) == SUCCESS)
+                break;
+            EEPROM_recover(&location);
+        }
+        if (attempt == g_policy.attempts)
+        {
+            g_errorCount++;
+            return ERROR;
+        }
+
+        /* ACK polling, the next page or the caller goes on as soon as the cycle is over */
+        g_lastWritten = EEPROM_slaW(&location);
+        if (EEPROM_waitReady(EEPROM_READY_TIMEOUT_MS) == ERROR)
+            return ERROR;
+
+        u16addr += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return SUCCESS;
+}
+
+uint8 EEPROM_readBlock(uint16 u16addr, uint8 *data, uint16 length)
+{
+    EEPROM_LocationType location;
+    uint16 chunk;
+    uint8 attempt;
+
+    if ((uint32)u16addr + length > g_capacity)
+        return ERROR;
+
+    /* The polling functions can not share the bus with the interrupt driven engine */
+    TWI_waitIdle();
+
+    /* One burst per chip, the address counter of a chip rolls over at its end */
+    while (length != 0)
+    {
+        EEPROM_locate(u16addr, &location);
+        chunk = (location.left < length) ? (uint16)location.left : length;
+
+        for (attempt = 0; attempt < g_policy.attempts; attempt++)
+        {
+            if (EEPROM_readBlockOnce(&location, data, chunk) == SUCCESS)
+                break;
+            EEPROM_recover(&location);
+        }
+        if (attempt == g_policy.attempts)
+        {
+            g_errorCount++;
+            return ERROR;
+        }
+
+        u16addr += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return SUCCESS;
+}
+
+void EEPROM_setRetryPolicy(const EEPROM_RetryPolicyType *Policy_Ptr)
+{
+    g_policy = *Policy_Ptr;
+    if (g_policy.attempts == 0)
+        g_policy.attempts = 1;
+}
+
+uint16 EEPROM_getErrorCount(void)
+{
+    return g_errorCount;
+}
+
+boolean EEPROM_readAsync(TWI_TransactionType *Transaction_Ptr, uint16 u16addr, uint8 *data, uint8 length)
+{
+    EEPROM_LocationType location;
+
+    if (EEPROM_locate(u16addr, &location) == ERROR || length > location.left)
+        return FALSE;
+
+    /* Dummy write of the memory location address then a sequential read */
+    EEPROM_setupTransaction(Transaction_Ptr, &location);
+    Transaction_Ptr->rx_data = data;
+    Transaction_Ptr->rx_length = length;
+    return TWI_submit(Transaction_Ptr);
+}
+
+boolean EEPROM_writeAsync(TWI_TransactionType *Transaction_Ptr, uint16 u16addr, const uint8 *data, uint8 length)
+{
+    EEPROM_LocationType location;
+
+    if (EEPROM_locate(u16addr, &location) == ERROR || length > location.left)
+        return FALSE;
+
+    /* Memory location address followed by the page data */
+    EEPROM_setupTransaction(Transaction_Ptr, &location);
+    Transaction_Ptr->tx_data = data;
+    Transaction_Ptr->tx_length = length;
+    if (!TWI_submit(Transaction_Ptr))
+        return FALSE;
+
+    g_lastWritten = Transaction_Ptr->slave_address;
+    return TRUE;
+}
@@ -15,6 +15,7 @@
 #define EXTERNAL_EEPROM_H_
 
 #include "std_types.h"
+#include "twi.h"
 
 /*******************************************************************************
  *                      Preprocessor Macros                                    *
@@ -22,11 +23,123 @@
 #define ERROR 0
 #define SUCCESS 1
 
+#define EEPROM_DEVICE_ADDRESS   0xA0    /* Device address of a 24Cxx with the A2..A0 pins low */
+#define EEPROM_MAX_DEVICES      8       /* One per value of the A2..A0 pins */
+#define EEPROM_PAGE_SIZE        16      /* Write unit of the upper layers, a divisor of the page of every device */
+#define EEPROM_READY_TIMEOUT_MS 20      /* Give up ACK polling after twice the worst case write cycle (tWR = 10 ms) */
+#define EEPROM_DEFAULT_ATTEMPTS 3       /* Tries of one operation until EEPROM_setRetryPolicy is called */
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+/*
+ * Retry policy of the polled functions. A failed attempt is ended with a STOP, then
+ * a NACK from a busy device waits for the write cycle and a timeout or bus fault
+ * clears the bus with TWI_recoverBus (if recover_bus is TRUE) before the next attempt.
+ */
+typedef struct{
+    uint8 attempts;         /* Tries of one operation (one page for EEPROM_writeBlock), at least 1 */
+    boolean recover_bus;
+}EEPROM_RetryPolicyType;
+
+/*
+ * One chip of the bus. The chips of EEPROM_ConfigType are mapped one after the other
+ * on a single address space of at most 64 KB, block operations cross the chips.
+ */
+typedef struct{
+    uint8 bus_address;      /* SLA+W: EEPROM_DEVICE_ADDRESS | A2..A0 pins << 1 */
+    uint8 address_bytes;    /* 1: 24C01..24C16, A8..A10 are sent in the device address; 2: 24C32..24C512 */
+    uint8 page_size;        /* Bytes of one write cycle, a power of two */
+    uint32 capacity;        /* Bytes, a multiple of page_size */
+}EEPROM_DeviceType;
+
+typedef struct{
+    const EEPROM_DeviceType *devices;
+    uint8 device_count;
+}EEPROM_ConfigType;
+
+/* Descriptors of the common parts, pins: level of the A2..A0 pins */
+#define EEPROM_24C16            { EEPROM_DEVICE_ADDRESS, 1, 16, 2048 }
+#define EEPROM_24C32(pins)      { EEPROM_DEVICE_ADDRESS | ((pins) << 1), 2, 32, 4096 }
+#define EEPROM_24C64(pins)      { EEPROM_DEVICE_ADDRESS | ((pins) << 1), 2, 32, 8192 }
+#define EEPROM_24C128(pins)     { EEPROM_DEVICE_ADDRESS | ((pins) << 1), 2, 64, 16384 }
+#define EEPROM_24C256(pins)     { EEPROM_DEVICE_ADDRESS | ((pins) << 1), 2, 64, 32768 }
+#define EEPROM_24C512(pins)     { EEPROM_DEVICE_ADDRESS | ((pins) << 1), 2, 128, 65536 }
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
+/*
+ * Description :
+ * Set the chips of the bus, until it is called the bus holds one 24C16.
+ * The devices array is copied. Returns ERROR, keeping the previous chips, if a descriptor
+ * is not valid, if a page is smaller than EEPROM_PAGE_SIZE, if two chips answer the same
+ * device address (a 1 byte address chip takes one per 256 bytes) or if the chips hold more
+ * than 64 KB.
+ */
+uint8 EEPROM_init(const EEPROM_ConfigType *Config_Ptr);
+
+/*
+ * Description :
+ * Return the size of the address space, the sum of the capacities of the chips.
+ */
+uint32 EEPROM_getCapacity(void);
+
 uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data);
+
+/*
+ * Description :
+ * Wait until the chip written last is done with its internal write cycle by polling its
+ * address until it answers with ACK. Returns SUCCESS as soon as it does, or ERROR after timeout_ms.
+ */
+uint8 EEPROM_waitReady(uint16 timeout_ms);
 uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data);
+
+/*
+ * Description :
+ * Write length bytes starting at u16addr. The data is split on the page and chip
+ * boundaries and each page is written with one write cycle, the function returns
+ * as soon as the device ACKs again after the last write cycle. Returns SUCCESS or ERROR.
+ */
+uint8 EEPROM_writeBlock(uint16 u16addr, const uint8 *data, uint16 length);
+
+/*
+ * Description :
+ * Read length bytes starting at u16addr with one addressing phase per chip followed by
+ * a sequential read burst (ACK after every byte except the last one).
+ * Returns SUCCESS or ERROR.
+ */
+uint8 EEPROM_readBlock(uint16 u16addr, uint8 *data, uint16 length);
+
+/*
+ * Description :
+ * Queue a read of length bytes at u16addr on the interrupt driven TWI engine.
+ * The call back and the buffer must stay valid until the transaction completes.
+ * Returns FALSE if the bytes are not in one chip or if the TWI queue is full.
+ */
+boolean EEPROM_readAsync(TWI_TransactionType *Transaction_Ptr, uint16 u16addr, uint8 *data, uint8 length);
+
+/*
+ * Description :
+ * Queue a write of length bytes at u16addr on the interrupt driven TWI engine.
+ * The bytes must not cross a page of the chip (an EEPROM_PAGE_SIZE boundary never does)
+ * and the chip NACKs any access until its internal write cycle is over.
+ * Returns FALSE if the bytes are not in one chip or if the TWI queue is full.
+ */
+boolean EEPROM_writeAsync(TWI_TransactionType *Transaction_Ptr, uint16 u16addr, const uint8 *data, uint8 length);
+
+/*
+ * Description :
+ * Set the retry policy of the polled functions.
+ */
+void EEPROM_setRetryPolicy(const EEPROM_RetryPolicyType *Policy_Ptr);
+
+/*
+ * Description :
+ * Return the number of polled operations that failed after all their attempts.
+ */
+uint16 EEPROM_getErrorCount(void);
  
 #endif /* EXTERNAL_EEPROM_H_ */
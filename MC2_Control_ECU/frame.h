@@ -0,0 +1,130 @@
+/******************************************************************************
+ *
+ * Module: Frame
+ *
+ * File Name: frame.h
+ *
+ * Description: Header file for the inter-ECU framing layer over UART
+ *
+ * Frame format:
+ * [START 0x7E] [TYPE] [SEQ] [LENGTH] [PAYLOAD 0..FRAME_MAX_PAYLOAD] [CRC16 HIGH] [CRC16 LOW]
+ * The CRC-16 covers TYPE, SEQ, LENGTH and PAYLOAD.
+ * SEQ numbers the requests of the HMI, a resent request keeps its number and the reply
+ * carries the number of the request it answers.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef FRAME_H_
+#define FRAME_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define FRAME_START_BYTE        0x7E    /* Marks the beginning of every frame */
+#define FRAME_MAX_PAYLOAD       26      /* Largest payload accepted by the parser, a full frame fills the UART ring buffers */
+#define FRAME_OVERHEAD          6       /* START + TYPE + SEQ + LENGTH + 2 CRC bytes */
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+typedef struct{
+	uint8 type;
+	uint8 seq;
+	uint8 length;
+	uint8 payload[FRAME_MAX_PAYLOAD];
+}FRAME_Type;
+
+typedef enum{
+	FRAME_INCOMPLETE, FRAME_COMPLETE, FRAME_CRC_ERROR, FRAME_LENGTH_ERROR, FRAME_TIMEOUT
+}FRAME_Status;
+
+typedef enum{
+	FRAME_WAIT_START, FRAME_WAIT_TYPE, FRAME_WAIT_SEQ, FRAME_WAIT_LENGTH, FRAME_WAIT_PAYLOAD,
+	FRAME_WAIT_CRC_HIGH, FRAME_WAIT_CRC_LOW
+}FRAME_ParserState;
+
+typedef struct{
+	FRAME_ParserState state;
+	uint8 index;
+	uint16 crc;
+	uint16 receivedCrc;
+	FRAME_Type frame;
+}FRAME_ParserType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Reset the parser so it hunts for the next start byte.
+ */
+void FRAME_parserInit(FRAME_ParserType *Parser_Ptr);
+
+/*
+ * Description :
+ * Feed one received byte to the streaming parser.
+ * Returns FRAME_COMPLETE when Parser_Ptr->frame holds a valid frame, FRAME_CRC_ERROR or
+ * FRAME_LENGTH_ERROR when a corrupted frame was dropped, FRAME_INCOMPLETE otherwise.
+ * After a complete or corrupted frame the parser resynchronizes on the next start byte.
+ */
+FRAME_Status FRAME_parseByte(FRAME_ParserType *Parser_Ptr, uint8 data);
+
+/*
+ * Description :
+ * Return the number of corrupted frames (CRC or length errors) seen by all parsers.
+ */
+uint16 FRAME_getErrorCount(void);
+
+/*
+ * Description :
+ * Set the sequence number carried by the frames sent from now on.
+ */
+void FRAME_setSequence(uint8 seq);
+
+/*
+ * Description :
+ * Keep a copy of every frame sent from now on in Frame_Ptr, NULL_PTR stops it.
+ */
+void FRAME_setCapture(FRAME_Type *Frame_Ptr);
+
+/*
+ * Description :
+ * Build a frame around the payload and send it through the UART.
+ */
+void FRAME_send(uint8 type, const uint8 *payload, uint8 length);
+
+/*
+ * Description :
+ * Send a frame again as it is, with its own sequence number.
+ */
+void FRAME_resend(const FRAME_Type *Frame_Ptr);
+
+/*
+ * Description :
+ * Block until a complete or a corrupted frame is received.
+ * Returns FRAME_COMPLETE with the frame copied to Frame_Ptr, or the error status.
+ */
+FRAME_Status FRAME_receive(FRAME_Type *Frame_Ptr);
+
+/*
+ * Description :
+ * Same as FRAME_receive but give up after timeout_ms milliseconds.
+ * Returns FRAME_TIMEOUT, and drops any partial frame, if the deadline expires.
+ */
+FRAME_Status FRAME_receiveTimeout(FRAME_Type *Frame_Ptr, uint16 timeout_ms);
+
+/*
+ * Description :
+ * Drop any partial frame and all the received bytes not parsed yet, used before
+ * sending a request so a late reply to a previous request is not taken for its reply.
+ */
+void FRAME_flush(void);
+
+#endif /* FRAME_H_ */
@@ -0,0 +1,83 @@
+/******************************************************************************
+ *
+ * Module: Lockout
+ *
+ * File Name: lockout.c
+ *
+ * Description: Source file for the wrong password lockout of the Control ECU
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "lockout.h"
+#include "clock.h"
+#include "logstore.h"
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+static LOCKOUT_ConfigType g_config;
+
+static uint8 g_failures = 0;            /* Consecutive wrong passwords, saturates at 255 */
+static uint32 g_lockedUntil = 0;        /* Clock second the lockout ends, 0: none yet */
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+/* Start the lockout earned by the current streak, if any */
+static boolean LOCKOUT_start(void) {
+	uint8 doublings;
+
+	if (g_failures < g_config.threshold)
+		return FALSE;
+
+	doublings = g_failures - g_config.threshold;
+	if (doublings > g_config.max_doublings)
+		doublings = g_config.max_doublings;
+	g_lockedUntil = CLOCK_getSeconds() + ((uint32) g_config.base_seconds << doublings);
+	return TRUE;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void LOCKOUT_init(const LOCKOUT_ConfigType *Config_Ptr) {
+	uint8 buffer[LOGSTORE_MAX_PAYLOAD];
+	uint8 length;
+
+	g_config = *Config_Ptr;
+	g_failures = 0;
+	g_lockedUntil = 0;
+
+	if (LOGSTORE_read(g_config.key, buffer, &length) == SUCCESS && length == sizeof(g_failures)) {
+		g_failures = buffer[0];
+	}
+	LOCKOUT_start();
+}
+
+uint16 LOCKOUT_getRemaining(void) {
+	uint32 now = CLOCK_getSeconds();
+
+	if (g_lockedUntil <= now)
+		return 0;
+	return (g_lockedUntil - now > 0xFFFF) ? 0xFFFF : (uint16)(g_lockedUntil - now);
+}
+
+boolean LOCKOUT_fail(void) {
+	if (g_failures < 0xFF)
+		g_failures++;
+	LOGSTORE_write(g_config.key, &g_failures, sizeof(g_failures));
+	return LOCKOUT_start();
+}
+
+void LOCKOUT_succeed(void) {
+	/* Only a streak in progress costs a write */
+	if (g_failures != 0) {
+		g_failures = 0;
+		LOGSTORE_write(g_config.key, &g_failures, sizeof(g_failures));
+	}
+}
@@ -0,0 +1,64 @@
+/******************************************************************************
+ *
+ * Module: Lockout
+ *
+ * File Name: lockout.h
+ *
+ * Description: Header file for the wrong password lockout of the Control ECU.
+ * After threshold consecutive wrong passwords the password checks are refused for
+ * base_seconds, every further wrong password after a lockout doubles the time, up to
+ * max_doublings times. A correct password ends the streak.
+ * The streak is kept in the log store, a reset starts its lockout again in full so it
+ * can not be used to skip one. The lockout is a deadline on the seconds clock, nothing
+ * waits for it to expire.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef LOCKOUT_H_
+#define LOCKOUT_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+typedef struct{
+	uint8 key;              /* Log store key of the streak */
+	uint8 threshold;        /* Consecutive wrong passwords that start the first lockout */
+	uint16 base_seconds;    /* Length of the first lockout */
+	uint8 max_doublings;    /* Longest lockout: base_seconds << max_doublings */
+}LOCKOUT_ConfigType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Load the streak from the log store, which must be initialized, and start its lockout
+ * again if it had one. CLOCK_init must have been called.
+ */
+void LOCKOUT_init(const LOCKOUT_ConfigType *Config_Ptr);
+
+/*
+ * Description :
+ * Return the seconds left before a password can be checked again, 0 if not locked out.
+ */
+uint16 LOCKOUT_getRemaining(void);
+
+/*
+ * Description :
+ * Count a wrong password. Returns TRUE if it starts a lockout.
+ */
+boolean LOCKOUT_fail(void);
+
+/*
+ * Description :
+ * Count a correct password, the streak is cleared.
+ */
+void LOCKOUT_succeed(void);
+
+#endif /* LOCKOUT_H_ */
@@ -0,0 +1,276 @@
+/******************************************************************************
+ *
+ * Module: Log Store
+ *
+ * File Name: logstore.c
+ *
+ * Description: Source file for the wear leveled record store of the Control ECU
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "logstore.h"
+#include "crc.h"
+#include <string.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define LOGSTORE_NO_SLOT        0xFF
+#define LOGSTORE_NO_KEY         0xFF
+
+/*
+ * Sequence numbers wrap around, a is newer than b if it is less than half the
+ * sequence space ahead of it. This holds as long as every valid record in the region
+ * is less than 32768 writes old, LOGSTORE_REFRESH_AGE keeps it that way.
+ */
+#define LOGSTORE_SEQ_NEWER(a, b)    ((sint16)((uint16)(a) - (uint16)(b)) > 0)
+
+/* A live record this many writes behind the newest one is appended again */
+#define LOGSTORE_REFRESH_AGE    16384
+
+/* Tries of a record write, the storage queue is drained between them */
+#define LOGSTORE_WRITE_ATTEMPTS 3
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+/* One slot of the region, exactly one storage page so a record takes one write cycle */
+typedef struct{
+	uint16 seq;                             /* Incremented by every write, all keys together */
+	uint8 key;
+	uint8 length;
+	uint8 payload[LOGSTORE_MAX_PAYLOAD];
+	uint16 crc;                             /* CRC16_compute() over all the fields above */
+}LOGSTORE_RecordType;
+
+typedef enum{
+	LOGSTORE_SLOT_VALID, LOGSTORE_SLOT_FREE, LOGSTORE_SLOT_READ_ERROR
+}LOGSTORE_SlotState;
+
+/* Where the newest record of a key is */
+typedef struct{
+	uint8 slot;
+	uint16 seq;
+}LOGSTORE_IndexType;
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+static LOGSTORE_ConfigType g_config;
+static LOGSTORE_IndexType g_index[LOGSTORE_MAX_KEYS];
+static uint8 g_slotOwner[LOGSTORE_MAX_SLOTS];  /* Key whose newest record is in the slot */
+static uint8 g_head = 0;                /* Slot the next record is appended to */
+static uint16 g_lastSeq = 0;            /* Sequence number of the newest record */
+static boolean g_ready = FALSE;         /* The last scan read every slot, appends are allowed */
+static uint16 g_errorCount = 0;         /* Records that could not be written */
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+static uint16 LOGSTORE_slotAddress(uint8 slot) {
+	return g_config.start_address + (uint16)slot * LOGSTORE_SLOT_SIZE;
+}
+
+/*
+ * Read a slot. A slot that could not be read is not free: it may hold the newest
+ * record of a key, only a slot read back with a bad CRC is.
+ */
+static LOGSTORE_SlotState LOGSTORE_readSlot(uint8 slot, LOGSTORE_RecordType *Record_Ptr) {
+	if (STORAGE_read(LOGSTORE_slotAddress(slot), (uint8 *) Record_Ptr,
+			sizeof(LOGSTORE_RecordType)) == ERROR) {
+		return LOGSTORE_SLOT_READ_ERROR;
+	}
+
+	if (Record_Ptr->crc == CRC16_compute((const uint8 *) Record_Ptr,
+			sizeof(LOGSTORE_RecordType) - sizeof(Record_Ptr->crc))
+			&& Record_Ptr->key < LOGSTORE_MAX_KEYS
+			&& Record_Ptr->length <= LOGSTORE_MAX_PAYLOAD) {
+		return LOGSTORE_SLOT_VALID;
+	}
+	return LOGSTORE_SLOT_FREE;
+}
+
+/* A slot is live while it holds the newest record of some key */
+static boolean LOGSTORE_isLive(uint8 slot) {
+	return (g_slotOwner[slot] != LOGSTORE_NO_KEY);
+}
+
+/* Make slot the newest record of key, its previous slot becomes free */
+static void LOGSTORE_setNewest(uint8 key, uint8 slot, uint16 seq) {
+	if (g_index[key].slot != LOGSTORE_NO_SLOT)
+		g_slotOwner[g_index[key].slot] = LOGSTORE_NO_KEY;
+	g_index[key].slot = slot;
+	g_index[key].seq = seq;
+	g_slotOwner[slot] = key;
+}
+
+static uint8 LOGSTORE_nextSlot(uint8 slot) {
+	return (slot + 1 == g_config.slots) ? 0 : slot + 1;
+}
+
+/*
+ * Write a new version of key in the next free slot. The new record never replaces the
+ * newest valid record of any key: until it is completely written (CRC correct) the
+ * previous version stays the newest one at boot, a power loss at any moment leaves
+ * either the old or the new version, never a mix of both.
+ * The storage may complete a write after it is queued or give it up after its retries,
+ * the write is waited for and read back before the index moves and the previous slot is
+ * freed. Returns ERROR, with the index unchanged, if the record is not in the storage.
+ */
+static uint8 LOGSTORE_append(uint8 key, const uint8 *data, uint8 length) {
+	LOGSTORE_RecordType record;
+	LOGSTORE_RecordType stored;
+	uint8 attempt;
+
+	/*
+	 * Garbage collection: a slot whose record was superseded is free and is reused when
+	 * the head comes back to it. Live slots are skipped, there are more slots than keys
+	 * so a free slot is always found.
+	 */
+	while (LOGSTORE_isLive(g_head)) {
+		g_head = LOGSTORE_nextSlot(g_head);
+	}
+
+	memset(&record, 0xFF, sizeof(record));
+	record.seq = ++g_lastSeq;
+	record.key = key;
+	record.length = length;
+	memcpy(record.payload, data, length);
+	record.crc = CRC16_compute((const uint8 *) &record,
+			sizeof(record) - sizeof(record.crc));
+
+	/* The record is one aligned page: one write cycle, no page roll-over */
+	for (attempt = 0; attempt < LOGSTORE_WRITE_ATTEMPTS; attempt++) {
+		if (STORAGE_write(LOGSTORE_slotAddress(g_head), (const uint8 *) &record,
+				sizeof(record)))
+			break;
+		STORAGE_flush(); /* Bounded wait for the storage to take more writes */
+	}
+	if (attempt == LOGSTORE_WRITE_ATTEMPTS) {
+		g_lastSeq--;
+		g_errorCount++;
+		return ERROR;
+	}
+
+	/*
+	 * The sequence number stays taken: the slot may hold the record even if it can not
+	 * be read back, a later record must still be newer at boot.
+	 */
+	STORAGE_flush();
+	if (LOGSTORE_readSlot(g_head, &stored) != LOGSTORE_SLOT_VALID
+			|| memcmp(&stored, &record, sizeof(record)) != 0) {
+		g_head = LOGSTORE_nextSlot(g_head);
+		g_errorCount++;
+		return ERROR;
+	}
+
+	LOGSTORE_setNewest(key, g_head, record.seq);
+	g_head = LOGSTORE_nextSlot(g_head);
+	return SUCCESS;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+#if LOGSTORE_MAX_PAYLOAD < 1
+#error "LOGSTORE_SLOT_SIZE is too small for a record"
+#endif
+
+uint8 LOGSTORE_init(const LOGSTORE_ConfigType *Config_Ptr) {
+	LOGSTORE_RecordType record;
+	LOGSTORE_SlotState state;
+	uint8 newest = LOGSTORE_NO_SLOT;
+
+	g_ready = FALSE;
+	g_lastSeq = 0;
+	if ((Config_Ptr->start_address & (LOGSTORE_SLOT_SIZE - 1)) != 0
+			|| Config_Ptr->slots <= LOGSTORE_MAX_KEYS
+			|| Config_Ptr->slots > LOGSTORE_MAX_SLOTS) {
+		return ERROR;
+	}
+	g_config = *Config_Ptr;
+
+	for (uint8 key = 0; key < LOGSTORE_MAX_KEYS; key++) {
+		g_index[key].slot = LOGSTORE_NO_SLOT;
+	}
+	for (uint8 slot = 0; slot < LOGSTORE_MAX_SLOTS; slot++) {
+		g_slotOwner[slot] = LOGSTORE_NO_KEY;
+	}
+
+	/* One pass over the region: newest record of every key and newest record overall */
+	for (uint8 slot = 0; slot < g_config.slots; slot++) {
+		state = LOGSTORE_readSlot(slot, &record);
+		if (state == LOGSTORE_SLOT_READ_ERROR)
+			return ERROR; /* The slot may be live, appending could overwrite it */
+		if (state == LOGSTORE_SLOT_FREE)
+			continue;
+
+		if (g_index[record.key].slot == LOGSTORE_NO_SLOT
+				|| LOGSTORE_SEQ_NEWER(record.seq, g_index[record.key].seq)) {
+			LOGSTORE_setNewest(record.key, slot, record.seq);
+		}
+		if (newest == LOGSTORE_NO_SLOT || LOGSTORE_SEQ_NEWER(record.seq, g_lastSeq)) {
+			newest = slot;
+			g_lastSeq = record.seq;
+		}
+	}
+
+	/* Appending goes on right after the newest record */
+	g_head = (newest == LOGSTORE_NO_SLOT) ? 0 : LOGSTORE_nextSlot(newest);
+	g_ready = TRUE;
+
+	return SUCCESS;
+}
+
+uint8 LOGSTORE_read(uint8 key, uint8 *data, uint8 *length_Ptr) {
+	LOGSTORE_RecordType record;
+
+	/* Before a region is set the index is not */
+	if (g_config.slots == 0 || key >= LOGSTORE_MAX_KEYS || g_index[key].slot == LOGSTORE_NO_SLOT)
+		return ERROR;
+
+	if (LOGSTORE_readSlot(g_index[key].slot, &record) != LOGSTORE_SLOT_VALID)
+		return ERROR;
+
+	memcpy(data, record.payload, record.length);
+	*length_Ptr = record.length;
+
+	return SUCCESS;
+}
+
+uint8 LOGSTORE_write(uint8 key, const uint8 *data, uint8 length) {
+	uint8 payload[LOGSTORE_MAX_PAYLOAD];
+	uint8 payloadLength;
+
+	if (!g_ready || key >= LOGSTORE_MAX_KEYS || length > LOGSTORE_MAX_PAYLOAD)
+		return ERROR;
+
+	if (LOGSTORE_append(key, data, length) == ERROR)
+		return ERROR;
+
+	/*
+	 * A key written rarely keeps its record in place while the sequence numbers go on,
+	 * move it forward before it gets too old for LOGSTORE_SEQ_NEWER. This costs one
+	 * extra write every LOGSTORE_REFRESH_AGE writes at most.
+	 */
+	for (uint8 other = 0; other < LOGSTORE_MAX_KEYS; other++) {
+		if (g_index[other].slot != LOGSTORE_NO_SLOT
+				&& (uint16)(g_lastSeq - g_index[other].seq) >= LOGSTORE_REFRESH_AGE
+				&& LOGSTORE_read(other, payload, &payloadLength) == SUCCESS) {
+			LOGSTORE_append(other, payload, payloadLength);
+		}
+	}
+
+	return SUCCESS;
+}
+
+uint16 LOGSTORE_getErrorCount(void) {
+	return g_errorCount;
+}
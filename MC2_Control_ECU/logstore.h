@@ -0,0 +1,85 @@
+/******************************************************************************
+ *
+ * Module: Log Store
+ *
+ * File Name: logstore.h
+ *
+ * Description: Header file for the wear leveled record store of the Control ECU.
+ * Every write appends a new version of a keyed record to the next slot of a storage
+ * region instead of rewriting the same cells, the slots are used round-robin so the
+ * wear is spread over the whole region.
+ * Updates are atomic across a power loss: a new version never overwrites the newest
+ * valid one and the boot scan picks the newest record with a correct CRC. With one key
+ * and two slots this is the classic A/B double buffered record.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef LOGSTORE_H_
+#define LOGSTORE_H_
+
+#include "std_types.h"
+#include "storage.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+/* One record per storage page: seq (2) + key (1) + length (1) + payload + crc (2) */
+#define LOGSTORE_SLOT_SIZE      STORAGE_PAGE_SIZE
+#define LOGSTORE_MAX_PAYLOAD    (LOGSTORE_SLOT_SIZE - 6)
+
+#define LOGSTORE_MAX_KEYS       52      /* Keys are 0 .. LOGSTORE_MAX_KEYS - 1 */
+#define LOGSTORE_MAX_SLOTS      64      /* Largest region: 64 pages = 1 KB */
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+typedef struct{
+	uint16 start_address;   /* First byte of the region, aligned on LOGSTORE_SLOT_SIZE */
+	uint8 slots;            /* Region size in slots, at least LOGSTORE_MAX_KEYS + 1 so a free slot always exists */
+}LOGSTORE_ConfigType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Scan the region once and index the newest valid record of every key. A slot with a
+ * bad CRC (erased, torn by a power loss or never written) is free. Returns ERROR for a bad
+ * configuration or if a slot could not be read, LOGSTORE_write is then refused until a
+ * later call scans the whole region.
+ */
+uint8 LOGSTORE_init(const LOGSTORE_ConfigType *Config_Ptr);
+
+/*
+ * Description :
+ * Copy the newest record of key to data and its length to length_Ptr, data must hold
+ * LOGSTORE_MAX_PAYLOAD bytes. Returns ERROR if the key has no valid record or if
+ * LOGSTORE_init never accepted a region.
+ */
+uint8 LOGSTORE_read(uint8 key, uint8 *data, uint8 *length_Ptr);
+
+/*
+ * Description :
+ * Append a new version of key. The record goes to the next free slot after the newest
+ * one, slots still holding the newest record of another key are skipped so a live
+ * record is never overwritten. The write is waited for and read back, the new record
+ * becomes the one read only once it is in the storage.
+ * A record of length 0 can be used to mark a deleted entry.
+ * Returns ERROR for a bad key or length, before a complete scan of the region, if the
+ * storage still refuses the record after LOGSTORE_WRITE_ATTEMPTS tries or if it does not
+ * read back, the previous version then stays the one read.
+ */
+uint8 LOGSTORE_write(uint8 key, const uint8 *data, uint8 length);
+
+/*
+ * Description :
+ * Return the number of records that could not be written since the start.
+ */
+uint16 LOGSTORE_getErrorCount(void);
+
+#endif /* LOGSTORE_H_ */
@@ -0,0 +1,63 @@
+/******************************************************************************
+ *
+ * Module: Password
+ *
+ * File Name: password.c
+ *
+ * Description: Source file for the packed password encoding shared by both ECUs
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "password.h"
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+uint8 PASSWORD_pack(const uint8 *digits, uint8 length, uint8 *packed) {
+	if (length < PASSWORD_MIN_LENGTH || length > PASSWORD_MAX_LENGTH)
+		return 0;
+
+	packed[0] = length;
+	for (uint8 i = 0; i < length; i += 2) {
+		uint8 high = digits[i];
+		uint8 low = (i + 1 < length) ? digits[i + 1] : PASSWORD_PAD_NIBBLE;
+
+		if (high > 9 || (i + 1 < length && low > 9))
+			return 0;
+		packed[1 + i / 2] = (uint8)(high << 4) | low;
+	}
+	return PASSWORD_PACKED_SIZE(length);
+}
+
+uint8 PASSWORD_unpack(const uint8 *packed, uint8 size, uint8 *digits, uint8 *length_Ptr) {
+	uint8 length;
+
+	if (size < 1)
+		return 0;
+	length = packed[0];
+	if (length < PASSWORD_MIN_LENGTH || length > PASSWORD_MAX_LENGTH
+			|| size < PASSWORD_PACKED_SIZE(length))
+		return 0;
+
+	for (uint8 i = 0; i < length; i += 2) {
+		uint8 high = packed[1 + i / 2] >> 4;
+		uint8 low = packed[1 + i / 2] & 0x0F;
+
+		if (high > 9)
+			return 0;
+		digits[i] = high;
+		if (i + 1 < length) {
+			if (low > 9)
+				return 0;
+			digits[i + 1] = low;
+		} else if (low != PASSWORD_PAD_NIBBLE) {
+			return 0;
+		}
+	}
+
+	*length_Ptr = length;
+	return PASSWORD_PACKED_SIZE(length);
+}
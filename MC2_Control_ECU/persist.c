@@ -0,0 +1,164 @@
+/******************************************************************************
+ *
+ * Module: Persist
+ *
+ * File Name: persist.c
+ *
+ * Description: Source file for the EEPROM write-behind queue of the Control ECU
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "persist.h"
+#include "twi.h"
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+typedef struct{
+	uint16 address;
+	uint8 data[PERSIST_MAX_DATA];
+	uint8 length;
+}PERSIST_JobType;
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+/*
+ * Queued writes, the job at g_head is the one being drained. It stays in the queue
+ * until its last page is written so the TWI engine can send from its data buffer.
+ */
+static PERSIST_JobType g_queue[PERSIST_QUEUE_SIZE];
+static uint8 g_head = 0;
+static volatile uint8 g_count = 0;
+
+/* Progress of the job at g_head */
+static uint8 g_offset;                  /* Bytes of the job already written */
+static uint8 g_chunk;                   /* Bytes of the page being written */
+static uint16 g_attempts;
+static uint8 g_busErrors;
+
+static TWI_TransactionType g_transaction;
+static volatile uint16 g_errorCount = 0;
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+static void PERSIST_transferDone(TWI_TransactionType *Transaction_Ptr);
+
+/* Submit the next page of the job at g_head, interrupts must be disabled */
+static void PERSIST_startChunk(void) {
+	PERSIST_JobType *job = &g_queue[g_head];
+	uint16 address = job->address + g_offset;
+
+	/* Bytes left until the end of the current EEPROM page */
+	g_chunk = EEPROM_PAGE_SIZE - (address & (EEPROM_PAGE_SIZE - 1));
+	if (g_chunk > job->length - g_offset)
+		g_chunk = job->length - g_offset;
+
+	g_transaction.callBack = PERSIST_transferDone;
+	/* The transaction is the only one of this module so the TWI queue always has room,
+	 * the polled EEPROM functions wait while it is in the queue */
+	EEPROM_writeAsync(&g_transaction, address, &job->data[g_offset], g_chunk);
+}
+
+/*
+ * TWI call back, runs in interrupt context at the end of every page write.
+ * While the EEPROM is busy with the write cycle of the previous page it NACKs its
+ * address, the page is then submitted again: this is the ACK polling of the
+ * write cycle without any waiting in the superloop.
+ */
+static void PERSIST_transferDone(TWI_TransactionType *Transaction_Ptr) {
+	if (Transaction_Ptr->result == TWI_DONE) {
+		g_offset += g_chunk;
+		g_attempts = 0;
+		g_busErrors = 0;
+	} else if ((Transaction_Ptr->result == TWI_BUS_ERROR && ++g_busErrors >= PERSIST_MAX_BUS_ERRORS)
+			|| ++g_attempts >= PERSIST_MAX_ATTEMPTS) {
+		/* The device does not answer any more or the bus keeps failing,
+		 * drop the job and go on with the next one */
+		g_offset = g_queue[g_head].length;
+		g_attempts = 0;
+		g_busErrors = 0;
+		g_errorCount++;
+	}
+
+	if (g_offset >= g_queue[g_head].length) {
+		g_head = (g_head + 1) & (PERSIST_QUEUE_SIZE - 1);
+		g_count--;
+		g_offset = 0;
+	}
+
+	if (g_count != 0)
+		PERSIST_startChunk();
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+#if (PERSIST_QUEUE_SIZE & (PERSIST_QUEUE_SIZE - 1)) != 0
+#error "PERSIST_QUEUE_SIZE must be a power of two"
+#endif
+
+boolean PERSIST_write(uint16 u16addr, const uint8 *data, uint8 length) {
+	PERSIST_JobType *job;
+	uint8 sreg;
+
+	if (length == 0 || length > PERSIST_MAX_DATA
+			|| (uint32) u16addr + length > EEPROM_getCapacity())
+		return FALSE;
+
+	sreg = SREG;
+	cli();
+	if (g_count == PERSIST_QUEUE_SIZE) {
+		SREG = sreg;
+		return FALSE;
+	}
+
+	job = &g_queue[(g_head + g_count) & (PERSIST_QUEUE_SIZE - 1)];
+	job->address = u16addr;
+	job->length = length;
+	memcpy(job->data, data, length);
+	g_count++;
+
+	/* The drain is idle, start it with this job */
+	if (g_count == 1) {
+		g_offset = 0;
+		g_attempts = 0;
+		g_busErrors = 0;
+		PERSIST_startChunk();
+	}
+	SREG = sreg;
+
+	return TRUE;
+}
+
+boolean PERSIST_isBusy(void) {
+	return (g_count != 0);
+}
+
+void PERSIST_flush(void) {
+	/* A stalled bus is recovered, aborting the page on the bus, so this always ends */
+	while (PERSIST_isBusy())
+		TWI_waitIdle();
+
+	/* The last page is on the bus, wait for its write cycle */
+	EEPROM_waitReady(EEPROM_READY_TIMEOUT_MS);
+}
+
+uint16 PERSIST_getErrorCount(void) {
+	uint16 count;
+	uint8 sreg = SREG;
+	cli();
+	count = g_errorCount;
+	SREG = sreg;
+	return count;
+}
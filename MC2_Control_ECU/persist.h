@@ -0,0 +1,62 @@
+/******************************************************************************
+ *
+ * Module: Persist
+ *
+ * File Name: persist.h
+ *
+ * Description: Header file for the EEPROM write-behind queue of the Control ECU.
+ * Writes are copied into a queue and return immediately, the queue is drained to the
+ * external EEPROM by the interrupt driven TWI engine while the superloop keeps running.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef PERSIST_H_
+#define PERSIST_H_
+
+#include "std_types.h"
+#include "external_eeprom.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define PERSIST_QUEUE_SIZE      4                   /* Number of writes waiting to be drained */
+#define PERSIST_MAX_DATA        EEPROM_PAGE_SIZE    /* Largest write accepted by PERSIST_write */
+#define PERSIST_MAX_ATTEMPTS    1000                /* NACKed attempts per page before a write is dropped */
+#define PERSIST_MAX_BUS_ERRORS  3                   /* Aborted attempts (bus fault, recovery) per page before a write is dropped */
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Queue length bytes to be written at u16addr, the data is copied so the caller
+ * buffer can be reused right away. Writes are drained in the order they are queued.
+ * Returns FALSE, without queuing anything, if length is 0 or larger than
+ * PERSIST_MAX_DATA, if the bytes are past the last chip or if the queue is full.
+ */
+boolean PERSIST_write(uint16 u16addr, const uint8 *data, uint8 length);
+
+/*
+ * Description :
+ * Return TRUE while some queued write is not yet on the EEPROM bus.
+ */
+boolean PERSIST_isBusy(void);
+
+/*
+ * Description :
+ * Barrier: wait until every queued write is done and the EEPROM finished its last
+ * write cycle. The polled EEPROM functions may be used safely after this call.
+ */
+void PERSIST_flush(void);
+
+/*
+ * Description :
+ * Return the number of queued writes dropped after PERSIST_MAX_ATTEMPTS failed attempts.
+ */
+uint16 PERSIST_getErrorCount(void);
+
+#endif /* PERSIST_H_ */
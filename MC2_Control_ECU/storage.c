@@ -0,0 +1,151 @@
+/******************************************************************************
+ *
+ * Module: Storage
+ *
+ * File Name: storage.c
+ *
+ * Description: Source file for the persistent storage interface of the Control ECU
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "storage.h"
+
+#if (STORAGE_BACKEND == STORAGE_BACKEND_EXTERNAL)
+
+/*******************************************************************************
+ *              External 24Cxx EEPROM: polled reads, write-behind queue        *
+ *******************************************************************************/
+
+#include "twi.h"
+#include "persist.h"
+
+static const EEPROM_DeviceType g_devices[] = { STORAGE_EEPROM_DEVICES };
+static uint16 g_initErrors = 0;
+
+uint8 STORAGE_init(void) {
+	TWI_ConfigType TWI_Config_Data = { 400000, 1 };
+	EEPROM_ConfigType EEPROM_Config_Data = { g_devices, sizeof(g_devices) / sizeof(g_devices[0]) };
+	EEPROM_RetryPolicyType EEPROM_Policy = { STORAGE_RETRY_ATTEMPTS, STORAGE_RETRY_RECOVER };
+	uint8 state;
+	TWI_init(&TWI_Config_Data);
+	state = EEPROM_init(&EEPROM_Config_Data);
+	EEPROM_setRetryPolicy(&EEPROM_Policy);
+
+	/* The chips of STORAGE_EEPROM_DEVICES were refused, the driver kept its previous ones */
+	if (state == ERROR)
+		g_initErrors++;
+	return state;
+}
+
+uint8 STORAGE_read(uint16 address, uint8 *data, uint16 length) {
+	/* The polled reads can not run while the queue owns the bus */
+	PERSIST_flush();
+	return EEPROM_readBlock(address, data, length);
+}
+
+boolean STORAGE_write(uint16 address, const uint8 *data, uint8 length) {
+	return PERSIST_write(address, data, length);
+}
+
+void STORAGE_flush(void) {
+	PERSIST_flush();
+}
+
+uint16 STORAGE_getErrorCount(void) {
+	return EEPROM_getErrorCount() + PERSIST_getErrorCount() + g_initErrors;
+}
+
+#elif (STORAGE_BACKEND == STORAGE_BACKEND_INTERNAL)
+
+/*******************************************************************************
+ *              Internal EEPROM: direct reads, blocking writes                 *
+ *******************************************************************************/
+
+#include <avr/eeprom.h>
+
+uint8 STORAGE_init(void) {
+	return SUCCESS;
+}
+
+uint8 STORAGE_read(uint16 address, uint8 *data, uint16 length) {
+	if ((uint32)address + length > STORAGE_CAPACITY)
+		return ERROR;
+
+	/* Waits for a write cycle in progress, then reads at CPU speed */
+	eeprom_read_block(data, (const void *) address, length);
+	return SUCCESS;
+}
+
+boolean STORAGE_write(uint16 address, const uint8 *data, uint8 length) {
+	if ((uint32)address + length > STORAGE_CAPACITY)
+		return FALSE;
+
+	/* Only the bytes that change are written, about 8.5 ms each */
+	eeprom_update_block(data, (void *) address, length);
+	return TRUE;
+}
+
+void STORAGE_flush(void) {
+	eeprom_busy_wait();
+}
+
+uint16 STORAGE_getErrorCount(void) {
+	return 0;
+}
+
+#elif (STORAGE_BACKEND == STORAGE_BACKEND_RAM)
+
+/*******************************************************************************
+ *              RAM mock: erased at init, no wear, no latency                  *
+ *******************************************************************************/
+
+#include <string.h>
+
+static uint8 g_memory[STORAGE_CAPACITY];
+static uint8 g_dropWrites = 0;
+static uint16 g_errorCount = 0;
+
+uint8 STORAGE_init(void) {
+	/* Same content as an erased EEPROM */
+	memset(g_memory, 0xFF, sizeof(g_memory));
+	g_dropWrites = 0;
+	g_errorCount = 0;
+	return SUCCESS;
+}
+
+uint8 STORAGE_read(uint16 address, uint8 *data, uint16 length) {
+	if ((uint32)address + length > STORAGE_CAPACITY)
+		return ERROR;
+
+	memcpy(data, &g_memory[address], length);
+	return SUCCESS;
+}
+
+boolean STORAGE_write(uint16 address, const uint8 *data, uint8 length) {
+	if ((uint32)address + length > STORAGE_CAPACITY)
+		return FALSE;
+
+	if (g_dropWrites != 0) {
+		g_dropWrites--;
+		g_errorCount++;
+		return TRUE;
+	}
+
+	memcpy(&g_memory[address], data, length);
+	return TRUE;
+}
+
+void STORAGE_flush(void) {
+}
+
+uint16 STORAGE_getErrorCount(void) {
+	return g_errorCount;
+}
+
+void STORAGE_RAM_dropWrites(uint8 count) {
+	g_dropWrites = count;
+}
+
+#endif
@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ * Module: Storage
+ *
+ * File Name: storage.h
+ *
+ * Description: Header file for the persistent storage interface of the Control ECU.
+ * The log store and the audit log only use this interface, the memory behind it is
+ * selected at compile time with STORAGE_BACKEND:
+ *  - STORAGE_BACKEND_EXTERNAL: 24Cxx chips over TWI, up to 64 KB, writes drained in the background
+ *  - STORAGE_BACKEND_INTERNAL: ATmega32 internal EEPROM, 1 KB, no bus on the read path
+ *  - STORAGE_BACKEND_RAM:      RAM array, 1 KB, lost at reset, host bench only (does not fit
+ *                              in the ATmega32 SRAM next to the application)
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef STORAGE_H_
+#define STORAGE_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define STORAGE_BACKEND_EXTERNAL    1
+#define STORAGE_BACKEND_INTERNAL    2
+#define STORAGE_BACKEND_RAM         3
+
+/* Static configuration: memory used by the application, the host bench selects the RAM mock */
+#ifndef STORAGE_BACKEND
+#define STORAGE_BACKEND             STORAGE_BACKEND_EXTERNAL
+#endif
+
+#if (STORAGE_BACKEND == STORAGE_BACKEND_EXTERNAL)
+#include "external_eeprom.h"
+#define STORAGE_EEPROM_DEVICES      EEPROM_24C16    /* Descriptors of the chips, in address order */
+#define STORAGE_CAPACITY            2048            /* Sum of their capacities, at most 65536 */
+#define STORAGE_PAGE_SIZE           EEPROM_PAGE_SIZE
+#define STORAGE_RETRY_ATTEMPTS      3       /* Tries of a polled read before it fails */
+#define STORAGE_RETRY_RECOVER       TRUE    /* Clear a stuck bus between the tries */
+#elif (STORAGE_BACKEND == STORAGE_BACKEND_INTERNAL)
+#define STORAGE_CAPACITY            1024
+#define STORAGE_PAGE_SIZE           16  /* No pages in this memory, records are still aligned on it */
+#elif (STORAGE_BACKEND == STORAGE_BACKEND_RAM)
+#ifdef __AVR__
+#error "STORAGE_BACKEND_RAM takes half of the ATmega32 SRAM, it is only for the host bench"
+#endif
+#define STORAGE_CAPACITY            1024    /* Same layout as the internal EEPROM */
+#define STORAGE_PAGE_SIZE           16
+#else
+#error "Unknown STORAGE_BACKEND"
+#endif
+
+#ifndef SUCCESS
+#define SUCCESS 1
+#endif
+#ifndef ERROR
+#define ERROR 0
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Initialize the selected memory and the peripherals it needs.
+ * Returns ERROR if the memory could not be set up, the failure is counted.
+ */
+uint8 STORAGE_init(void);
+
+/*
+ * Description :
+ * Read length bytes starting at address, writes still pending are flushed first.
+ * Returns SUCCESS or ERROR.
+ */
+uint8 STORAGE_read(uint16 address, uint8 *data, uint16 length);
+
+/*
+ * Description :
+ * Write length bytes (at most STORAGE_PAGE_SIZE, not crossing a page) starting at address.
+ * The data is copied, the write may complete after the call returns. Writes complete in
+ * the order they are made. Returns FALSE, without writing anything, if the write can not
+ * be accepted right now.
+ */
+boolean STORAGE_write(uint16 address, const uint8 *data, uint8 length);
+
+/*
+ * Description :
+ * Barrier: wait until every write made so far is complete.
+ */
+void STORAGE_flush(void);
+
+/*
+ * Description :
+ * Return the number of reads and writes that failed for good since the start,
+ * after all their retries.
+ */
+uint16 STORAGE_getErrorCount(void);
+
+#if (STORAGE_BACKEND == STORAGE_BACKEND_RAM)
+/*
+ * Description :
+ * Host bench only: accept the next count writes and give them up, as the write-behind
+ * queue of the EEPROM does with a write that keeps failing.
+ */
+void STORAGE_RAM_dropWrites(uint8 count);
+#endif
+
+#endif /* STORAGE_H_ */
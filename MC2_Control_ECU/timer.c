@@ -94,6 +94,10 @@ void Timer1_deInit(void) {
 }
 
 
+uint16 Timer1_getCount(void) {
+	return TCNT1;
+}
+
 void Timer1_setCallBack(void (*a_ptr)(void)) {
 	timer1_callBackPtr = a_ptr;
 	return;
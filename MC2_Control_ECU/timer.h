@@ -62,5 +62,7 @@ void Timer1_deInit(void);
 
 void Timer1_setCallBack(void(*a_ptr)(void));
 
+uint16 Timer1_getCount(void);
+
 
 #endif /* TIMER_H_ */
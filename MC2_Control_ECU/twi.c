@@ -13,8 +13,176 @@
 #include "twi.h"
 #include "common_macros.h"
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #include <util/delay.h>
 
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+/* Queue of the interrupt driven engine, g_queue[g_queueHead] is the active transaction */
+static TWI_TransactionType *volatile g_queue[TWI_QUEUE_SIZE];
+static volatile uint8 g_queueHead = 0;
+static volatile uint8 g_queueCount = 0;
+
+/* Progress of the active transaction */
+static volatile uint8 g_txIndex = 0;  /* Bytes sent from header followed by tx_data */
+static volatile uint8 g_rxIndex = 0;  /* Bytes received in rx_data */
+static volatile uint8 g_events = 0;   /* Incremented by every TWI interrupt, tells the engine is alive */
+
+/* Set when the last wait of the polling functions ran out of time */
+static boolean g_timedOut = FALSE;
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+/* Status bits of TWSR */
+static uint8 TWI_readStatus(void)
+{
+    return TWSR & 0xF8;
+}
+
+/* Bounded wait for the end of the current bus step */
+static void TWI_waitFlag(void)
+{
+    uint16 elapsed = 0;
+
+    g_timedOut = FALSE;
+    while(BIT_IS_CLEAR(TWCR,TWINT))
+    {
+        if(elapsed >= TWI_TIMEOUT_US)
+        {
+            g_timedOut = TRUE;
+            return;
+        }
+        _delay_us(1);
+        elapsed++;
+    }
+}
+
+/* Start the transaction at the head of the queue, stop_first sends a STOP before its START */
+static void TWI_startActive(boolean stop_first)
+{
+    g_txIndex = 0;
+    g_rxIndex = 0;
+    TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE)
+            | (stop_first ? (1 << TWSTO) : 0);
+}
+
+/* End the active transaction with the given result and start the next queued one */
+static void TWI_complete(TWI_ResultType result)
+{
+    TWI_TransactionType *transaction = g_queue[g_queueHead];
+
+    /*
+     * The call back runs while the transaction still counts as active, so a
+     * transaction submitted from the call back (a retry for example) is only
+     * queued and started below, never started on top of the active one.
+     */
+    transaction->result = result;
+    if(transaction->callBack != NULL_PTR)
+    {
+        transaction->callBack(transaction);
+    }
+
+    g_queueHead = (g_queueHead + 1) % TWI_QUEUE_SIZE;
+    g_queueCount--;
+
+    if(g_queueCount != 0)
+    {
+        /* Back to back: STOP immediately followed by the next START */
+        TWI_startActive(TRUE);
+    }
+    else
+    {
+        TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+    }
+}
+
+/*******************************************************************************
+ *                      Interrupt Service Routine                              *
+ *******************************************************************************/
+
+ISR(TWI_vect)
+{
+    TWI_TransactionType *transaction = g_queue[g_queueHead];
+    uint8 writeLength = transaction->header_length + transaction->tx_length;
+
+    g_events++;
+    switch(TWI_readStatus())
+    {
+    case TWI_START:
+    case TWI_REP_START:
+        /* Write phase first if there is anything to write and it was not done yet */
+        if(g_txIndex < writeLength)
+        {
+            TWDR = transaction->slave_address;
+        }
+        else
+        {
+            TWDR = transaction->slave_address | 1;
+        }
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+        break;
+
+    case TWI_MT_SLA_W_ACK:
+    case TWI_MT_DATA_ACK:
+        if(g_txIndex < writeLength)
+        {
+            TWDR = (g_txIndex < transaction->header_length) ?
+                    transaction->header[g_txIndex] :
+                    transaction->tx_data[g_txIndex - transaction->header_length];
+            g_txIndex++;
+            TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+        }
+        else if(transaction->rx_length != 0)
+        {
+            /* Repeated start for the read phase */
+            TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+        }
+        else
+        {
+            TWI_complete(TWI_DONE);
+        }
+        break;
+
+    case TWI_MT_SLA_R_ACK:
+        /* ACK every byte except the last one */
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE)
+                | ((transaction->rx_length > 1) ? (1 << TWEA) : 0);
+        break;
+
+    case TWI_MR_DATA_ACK:
+        transaction->rx_data[g_rxIndex] = TWDR;
+        g_rxIndex++;
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE)
+                | ((g_rxIndex < transaction->rx_length - 1) ? (1 << TWEA) : 0);
+        break;
+
+    case TWI_MR_DATA_NACK:
+        transaction->rx_data[g_rxIndex] = TWDR;
+        TWI_complete(TWI_DONE);
+        break;
+
+    case TWI_MT_SLA_W_NACK:
+    case TWI_MT_SLA_R_NACK:
+    case TWI_MT_DATA_NACK:
+        /* e.g. an EEPROM still busy with its internal write cycle */
+        TWI_complete(TWI_NACK);
+        break;
+
+    default:
+        /* Bus error or arbitration lost */
+        TWI_complete(TWI_BUS_ERROR);
+        break;
+    }
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
 void TWI_init(const TWI_ConfigType* Config_Ptr)
 {
     /* Bit Rate: 400.000 kbps using zero pre-scaler TWPS=00 and F_CPU=8Mhz */
@@ -40,7 +208,7 @@ void TWI_start(void)
     TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
     
     /* Wait for TWINT flag set in TWCR Register (start bit is send successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitFlag();
 }
 
 void TWI_stop(void)
@@ -63,7 +231,7 @@ void TWI_writeByte(uint8 data)
 	 */ 
     TWCR = (1 << TWINT) | (1 << TWEN);
     /* Wait for TWINT flag set in TWCR Register(data is send successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitFlag();
 }
 
 uint8 TWI_readByteWithACK(void)
@@ -75,7 +243,7 @@ uint8 TWI_readByteWithACK(void)
 	 */ 
     TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
     /* Wait for TWINT flag set in TWCR Register (data received successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitFlag();
     /* Read Data */
     return TWDR;
 }
@@ -88,7 +256,7 @@ uint8 TWI_readByteWithNACK(void)
 	 */
     TWCR = (1 << TWINT) | (1 << TWEN);
     /* Wait for TWINT flag set in TWCR Register (data received successfully) */
-    while(BIT_IS_CLEAR(TWCR,TWINT));
+    TWI_waitFlag();
     /* Read Data */
     return TWDR;
 }
@@ -97,6 +265,125 @@ uint8 TWI_getStatus(void)
 {
     uint8 status;
     /* masking to eliminate first 3 bits and get the last 5 bits (status bits) */
-    status = TWSR & 0xF8;
+    status = TWI_readStatus();
+    /* TWSR is meaningless if the last step never completed */
+    if(g_timedOut)
+    {
+        status = TWI_TIMEOUT;
+    }
     return status;
 }
+
+boolean TWI_submit(TWI_TransactionType *Transaction_Ptr)
+{
+    uint8 sreg = SREG;
+    boolean accepted = FALSE;
+
+    cli();
+    if(g_queueCount < TWI_QUEUE_SIZE)
+    {
+        Transaction_Ptr->result = TWI_PENDING;
+        g_queue[(g_queueHead + g_queueCount) % TWI_QUEUE_SIZE] = Transaction_Ptr;
+        g_queueCount++;
+        accepted = TRUE;
+
+        /* Idle bus, this transaction is the active one */
+        if(g_queueCount == 1)
+        {
+            TWI_startActive(FALSE);
+        }
+    }
+    SREG = sreg;
+
+    return accepted;
+}
+
+boolean TWI_isBusy(void)
+{
+    return (g_queueCount != 0);
+}
+
+boolean TWI_waitIdle(void)
+{
+    uint16 stalled = 0;
+    uint8 events = g_events;
+    boolean recovered = FALSE;
+
+    while(g_queueCount != 0)
+    {
+        _delay_us(10);
+        if(events != g_events)
+        {
+            events = g_events;
+            stalled = 0;
+        }
+        else if((stalled += 10) >= TWI_TIMEOUT_US)
+        {
+            /* No interrupt for a whole timeout: the engine will not finish on its own */
+            TWI_recoverBus();
+            recovered = TRUE;
+            stalled = 0;
+        }
+    }
+    return !recovered;
+}
+
+void TWI_recoverBus(void)
+{
+    TWI_TransactionType *aborted[TWI_QUEUE_SIZE];
+    uint8 abortedCount;
+    uint8 i;
+    uint8 sreg = SREG;
+
+    cli();
+
+    /* Take the queued transactions out of the engine */
+    abortedCount = g_queueCount;
+    for(i = 0; i < abortedCount; i++)
+    {
+        aborted[i] = g_queue[(g_queueHead + i) % TWI_QUEUE_SIZE];
+    }
+    g_queueCount = 0;
+
+    /* Disconnect the TWI module, the lines are released and pulled up by the bus resistors */
+    TWCR = 0;
+    CLEAR_BIT(PORTC,PC0);
+    CLEAR_BIT(PORTC,PC1);
+    CLEAR_BIT(DDRC,PC0);
+    CLEAR_BIT(DDRC,PC1);
+    _delay_us(5);
+
+    /* A slave stopped in the middle of a byte holds SDA low, clock it out */
+    for(i = 0; i < 9 && BIT_IS_CLEAR(PINC,PC1); i++)
+    {
+        SET_BIT(DDRC,PC0);      /* SCL low */
+        _delay_us(5);
+        CLEAR_BIT(DDRC,PC0);    /* SCL released */
+        _delay_us(5);
+    }
+
+    /* STOP condition: SDA goes high while SCL is high */
+    SET_BIT(DDRC,PC0);
+    SET_BIT(DDRC,PC1);
+    _delay_us(5);
+    CLEAR_BIT(DDRC,PC0);
+    _delay_us(5);
+    CLEAR_BIT(DDRC,PC1);
+    _delay_us(5);
+
+    /* TWBR and TWAR are untouched, enabling the module is enough */
+    TWCR = (1 << TWEN);
+    g_timedOut = FALSE;
+
+    /* The owners decide whether to retry, a call back may submit again */
+    for(i = 0; i < abortedCount; i++)
+    {
+        aborted[i]->result = TWI_BUS_ERROR;
+        if(aborted[i]->callBack != NULL_PTR)
+        {
+            aborted[i]->callBack(aborted[i]);
+        }
+    }
+
+    SREG = sreg;
+}
@@ -27,6 +27,20 @@
 #define TWI_MT_DATA_ACK   0x28 /* Master transmit data and ACK has been received from Slave. */
 #define TWI_MR_DATA_ACK   0x50 /* Master received data and send ACK to slave. */
 #define TWI_MR_DATA_NACK  0x58 /* Master received data but doesn't send ACK to slave. */
+#define TWI_MT_SLA_W_NACK 0x20 /* Master transmit ( slave address + Write request ) to slave + NACK received from slave. */
+#define TWI_MT_DATA_NACK  0x30 /* Master transmit data and NACK has been received from Slave. */
+#define TWI_ARB_LOST      0x38 /* Arbitration lost in slave address or data bytes. */
+#define TWI_MT_SLA_R_NACK 0x48 /* Master transmit ( slave address + Read request ) to slave + NACK received from slave. */
+
+/* Not a TWSR value: returned by TWI_getStatus when TWINT did not rise within TWI_TIMEOUT_US */
+#define TWI_TIMEOUT       0x01
+#define TWI_BUS_FAULT     0x00 /* Illegal START or STOP seen on the bus */
+
+/* Number of transactions the interrupt driven engine can hold, the active one included */
+#define TWI_QUEUE_SIZE    4
+
+/* Longest time one bus step may take, a byte takes about 90 us at 100 kbps */
+#define TWI_TIMEOUT_US    1000
 
 
 /*******************************************************************************
@@ -40,6 +54,31 @@ typedef struct{
 	uint8 TWI_Address;
 }TWI_ConfigType;
 
+typedef enum{
+	TWI_IDLE, TWI_PENDING, TWI_DONE, TWI_NACK, TWI_BUS_ERROR /* TWI_IDLE: never submitted */
+}TWI_ResultType;
+
+/*
+ * One bus transaction executed by the interrupt driven engine:
+ * START, SLA+W, header, tx_data, then if rx_length != 0 REPEATED START, SLA+R and
+ * rx_length bytes (ACK on all but the last one), then STOP.
+ * With no header and no tx_data the write phase is skipped and the transaction starts with SLA+R.
+ * The transaction and its buffers belong to the engine from TWI_submit until result
+ * leaves TWI_PENDING, the call back is called from the TWI interrupt at that moment
+ * (or from TWI_recoverBus, with interrupts disabled, for an aborted transaction).
+ */
+typedef struct TWI_Transaction{
+	uint8 slave_address;       /* Slave address in the SLA+W form (R/W bit = 0) */
+	uint8 header[2];           /* Sent first, e.g. the memory address of an EEPROM */
+	uint8 header_length;
+	const uint8 *tx_data;
+	uint8 tx_length;
+	uint8 *rx_data;
+	uint8 rx_length;
+	void (*callBack)(struct TWI_Transaction *Transaction_Ptr);
+	volatile TWI_ResultType result;
+}TWI_TransactionType;
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -51,5 +90,35 @@ uint8 TWI_readByteWithACK(void);
 uint8 TWI_readByteWithNACK(void);
 uint8 TWI_getStatus(void);
 
+/*
+ * Description :
+ * Queue a transaction for the interrupt driven engine, it is started right away if the
+ * bus is idle. Returns FALSE, without touching the transaction, if the queue is full.
+ */
+boolean TWI_submit(TWI_TransactionType *Transaction_Ptr);
+
+/*
+ * Description :
+ * Return TRUE while the engine has a transaction in progress or queued.
+ * The polling functions above must only be used while it returns FALSE.
+ */
+boolean TWI_isBusy(void);
+
+/*
+ * Description :
+ * Wait until the engine has no transaction left. If the engine makes no progress for
+ * TWI_TIMEOUT_US (stuck bus, lost interrupt) the bus is recovered with TWI_recoverBus.
+ * Returns FALSE if a recovery was needed.
+ */
+boolean TWI_waitIdle(void);
+
+/*
+ * Description :
+ * Bus-clear recovery: abort the queued transactions with TWI_BUS_ERROR, release the
+ * TWI pins, clock SCL (PC0) up to 9 times until a stuck slave releases SDA (PC1), send
+ * a STOP condition and enable the TWI module again with the same bit rate and address.
+ */
+void TWI_recoverBus(void);
+
 
 #endif /* TWI_H_ */
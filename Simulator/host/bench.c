@@ -0,0 +1,586 @@
+/******************************************************************************
+ *
+ * Module: Host Simulation
+ *
+ * File Name: bench.c
+ *
+ * Description: Storage bench of the Control ECU on the host. The EEPROM driver and
+ * the write-behind queue are run against a 24C16 model, then against two 24C32 models
+ * on the same bus: the model behaviour and the data written by the driver are checked,
+ * then the latency and throughput of every access path are reported in simulated bus
+ * time. The password hash is checked against known answers, its cycle count is only
+ * meaningful on the target (APP_GET_DIAGNOSTICS). The log store, the audit log and the
+ * wrong password lockout are run on the RAM storage backend with the layout of the 1 KB
+ * memories. Exits with 1 if a check failed.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "sim.h"
+#include "eeprom_model.h"
+#include "external_eeprom.h"
+#include "persist.h"
+#include "blake2s.h"
+#include "password.h"
+#include "storage.h"
+#include "logstore.h"
+#include "audit.h"
+#include "lockout.h"
+#include "clock.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define BENCH_BIT_RATE          400000
+#define BENCH_MEMORY_SIZE       2048
+#define BENCH_SINGLE_ACCESSES   64
+
+/* Regions of the RAM storage, as APP_AUDIT_* and APP_STORE_* for a 1 KB memory */
+#define BENCH_AUDIT_PAGES       11
+#define BENCH_STORE_START       0x00B0
+#define BENCH_STORE_SLOTS       53
+#define BENCH_LOCKOUT_KEY       51
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+/* 24C16 as on the board: 8 blocks of 256 bytes, 16 byte pages, tWR = 5 ms */
+static const EEPROM_MODEL_ConfigType g_device24C16 = { BENCH_MEMORY_SIZE, 16, 1, 0, 5000 };
+
+/* Two 2 byte address chips, A2..A0 = 0 and 1: one 8 KB address space */
+static const EEPROM_MODEL_ConfigType g_device24C32[] = {
+	{ 4096, 32, 2, 0, 5000 },
+	{ 4096, 32, 2, 1, 5000 }
+};
+static const EEPROM_DeviceType g_driver24C32[] = { EEPROM_24C32(0), EEPROM_24C32(1) };
+
+/* Chips answering the same device address, the 24C16 takes all of A2..A0 */
+static const EEPROM_DeviceType g_driverSamePins[] = { EEPROM_24C32(1), EEPROM_24C32(1) };
+static const EEPROM_DeviceType g_driverBlocks[] = { EEPROM_24C32(3), EEPROM_24C16 };
+
+static uint8 g_device;
+static uint8 g_failures = 0;
+static uint8 g_pattern[BENCH_MEMORY_SIZE];
+static uint8 g_readBack[BENCH_MEMORY_SIZE];
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+static void BENCH_check(boolean ok, const char *what) {
+	printf("  %-52s %s\n", what, ok ? "ok" : "FAILED");
+	if (!ok)
+		g_failures++;
+}
+
+static void BENCH_report(const char *what, uint64 ns, uint32 bytes) {
+	printf("  %-40s %10.1f us", what, ns / 1000.0);
+	if (bytes != 0)
+		printf("  %8.0f B/s", bytes * 1e9 / ns);
+	printf("\n");
+}
+
+/* Let a write cycle still running end, the next measure starts on an idle device */
+static void BENCH_settle(void) {
+	while (EEPROM_MODEL_isBusy(g_device))
+		SIM_delayUs(100);
+}
+
+/*
+ * Datasheet behaviour of the model, driven with the raw TWI functions so the checks do
+ * not depend on the driver under test.
+ */
+static void BENCH_checkModel(void) {
+	uint8 *memory = EEPROM_MODEL_getMemory(g_device);
+	uint8 expected[16];
+	uint8 data[4];
+	uint8 i;
+	boolean ok;
+
+	printf("24C16 model\n");
+
+	/* 20 bytes from offset 10 of page 0x100: the counter rolls over inside the page */
+	memcpy(expected, &memory[0x100], 16);
+	TWI_start();
+	TWI_writeByte(0xA0 | (0x01 << 1));
+	TWI_writeByte(0x0A);
+	for (i = 0; i < 20; i++) {
+		TWI_writeByte(0x40 + i);
+		expected[(0x0A + i) & 0x0F] = 0x40 + i;
+	}
+	TWI_stop();
+	BENCH_check(memcmp(&memory[0x100], expected, 16) == 0, "page write rolls over inside the page");
+
+	/* The device NACKs its address until tWR is over */
+	TWI_start();
+	TWI_writeByte(0xA0);
+	ok = (TWI_getStatus() == TWI_MT_SLA_W_NACK);
+	TWI_stop();
+	SIM_delayUs(g_device24C16.write_cycle_us);
+	TWI_start();
+	TWI_writeByte(0xA0);
+	ok = ok && (TWI_getStatus() == TWI_MT_SLA_W_ACK);
+	TWI_stop();
+	BENCH_check(ok, "address NACKed during the write cycle only");
+
+	/* A START before the STOP aborts the write */
+	TWI_start();
+	TWI_writeByte(0xA0);
+	TWI_writeByte(0x20);
+	TWI_writeByte(0x5A);
+	TWI_start();
+	TWI_stop();
+	BENCH_check(memory[0x20] != 0x5A && !EEPROM_MODEL_isBusy(g_device), "repeated START aborts a write");
+
+	/* Sequential read from the last byte goes on at the first one */
+	memory[0x7FF] = 0x11;
+	memory[0x000] = 0x22;
+	TWI_start();
+	TWI_writeByte(0xA0 | (0x07 << 1));
+	TWI_writeByte(0xFF);
+	TWI_start();
+	TWI_writeByte(0xA0 | (0x07 << 1) | 1);
+	data[0] = TWI_readByteWithACK();
+	data[1] = TWI_readByteWithNACK();
+	TWI_stop();
+	BENCH_check(data[0] == 0x11 && data[1] == 0x22, "sequential read rolls over at the end of the memory");
+
+	/* Only 0xA0 .. 0xAF answer */
+	TWI_start();
+	TWI_writeByte(0xB0);
+	BENCH_check(TWI_getStatus() == TWI_MT_SLA_W_NACK, "other device addresses are NACKed");
+	TWI_stop();
+}
+
+/* The driver against the model: block addressing, data integrity, access times */
+static void BENCH_runDriver(void) {
+	EEPROM_MODEL_StatsType stats;
+	uint64 start;
+	uint16 i;
+	uint8 value;
+	boolean ok;
+
+	printf("\nPolled driver, %lu kbps\n", (unsigned long) (BENCH_BIT_RATE / 1000));
+
+	for (i = 0; i < BENCH_MEMORY_SIZE; i++)
+		g_pattern[i] = (uint8) (i * 7 + (i >> 8));
+
+	/* A8..A10 go in the device address */
+	ok = (EEPROM_writeByte(0x5A3, 0xC3) == SUCCESS);
+	BENCH_check(ok && EEPROM_MODEL_getMemory(g_device)[0x5A3] == 0xC3, "writeByte reaches block 5");
+	BENCH_settle();
+
+	EEPROM_MODEL_resetStats(g_device);
+	start = SIM_getTimeNs();
+	ok = (EEPROM_writeBlock(0, g_pattern, BENCH_MEMORY_SIZE) == SUCCESS);
+	BENCH_report("writeBlock 2048 B", SIM_getTimeNs() - start, BENCH_MEMORY_SIZE);
+	EEPROM_MODEL_getStats(g_device, &stats);
+	BENCH_check(ok && memcmp(EEPROM_MODEL_getMemory(g_device), g_pattern, BENCH_MEMORY_SIZE) == 0,
+			"writeBlock data in the cells");
+	BENCH_check(stats.write_cycles == BENCH_MEMORY_SIZE / EEPROM_PAGE_SIZE, "writeBlock one write cycle per page");
+	printf("  %-40s %10lu\n", "  polls NACKed during tWR", (unsigned long) stats.busy_nacks);
+
+	start = SIM_getTimeNs();
+	ok = (EEPROM_readBlock(0, g_readBack, BENCH_MEMORY_SIZE) == SUCCESS);
+	BENCH_report("readBlock 2048 B", SIM_getTimeNs() - start, BENCH_MEMORY_SIZE);
+	BENCH_check(ok && memcmp(g_readBack, g_pattern, BENCH_MEMORY_SIZE) == 0, "readBlock data across the 8 blocks");
+
+	start = SIM_getTimeNs();
+	ok = TRUE;
+	for (i = 0; i < BENCH_SINGLE_ACCESSES; i++)
+		ok = ok && (EEPROM_writeByte(i * 31, (uint8) ~g_pattern[i * 31]) == SUCCESS);
+	BENCH_report("writeByte, mean", (SIM_getTimeNs() - start) / BENCH_SINGLE_ACCESSES, 0);
+
+	start = SIM_getTimeNs();
+	for (i = 0; i < BENCH_SINGLE_ACCESSES; i++) {
+		ok = ok && (EEPROM_readByte(i * 31, &value) == SUCCESS)
+				&& value == (uint8) ~g_pattern[i * 31];
+	}
+	BENCH_report("readByte, mean", (SIM_getTimeNs() - start) / BENCH_SINGLE_ACCESSES, 0);
+	BENCH_check(ok, "writeByte / readByte round trip");
+	BENCH_check(EEPROM_getErrorCount() == 0, "no operation failed");
+}
+
+/* Write-behind queue: what the caller waits for and when the data is safe */
+static void BENCH_runQueue(void) {
+	uint64 start;
+	uint64 queued;
+	uint8 page;
+	boolean ok = TRUE;
+
+	printf("\nWrite-behind queue, %u pages\n", PERSIST_QUEUE_SIZE);
+
+	BENCH_settle();
+	for (page = 0; page < PERSIST_QUEUE_SIZE; page++)
+		memset(&g_pattern[page * EEPROM_PAGE_SIZE], 0x80 + page, EEPROM_PAGE_SIZE);
+
+	start = SIM_getTimeNs();
+	for (page = 0; page < PERSIST_QUEUE_SIZE; page++) {
+		ok = ok && PERSIST_write(0x300 + page * EEPROM_PAGE_SIZE,
+				&g_pattern[page * EEPROM_PAGE_SIZE], EEPROM_PAGE_SIZE);
+	}
+	queued = SIM_getTimeNs() - start;
+	BENCH_report("PERSIST_write, caller time", queued, 0);
+
+	PERSIST_flush();
+	BENCH_report("drain until PERSIST_flush returns", SIM_getTimeNs() - start,
+			PERSIST_QUEUE_SIZE * EEPROM_PAGE_SIZE);
+
+	BENCH_check(ok && memcmp(&EEPROM_MODEL_getMemory(g_device)[0x300], g_pattern,
+			PERSIST_QUEUE_SIZE * EEPROM_PAGE_SIZE) == 0, "queued pages in the cells");
+	BENCH_check(PERSIST_getErrorCount() == 0, "no queued write dropped");
+}
+
+/* Known answers of the password hash, from RFC 7693 and the BLAKE2 reference test vectors */
+static void BENCH_checkHash(void) {
+	static const uint8 abc256[32] = {
+		0x50, 0x8C, 0x5E, 0x8C, 0x32, 0x7C, 0x14, 0xE2, 0xE1, 0xA7, 0x2B, 0xA3, 0x4E, 0xEB, 0x45, 0x2F,
+		0x37, 0x45, 0x8B, 0x20, 0x9E, 0xD6, 0x3A, 0x29, 0x4D, 0x99, 0x9B, 0x4C, 0x86, 0x67, 0x59, 0x82
+	};
+	static const uint8 keyedEmpty256[32] = {
+		0x48, 0xA8, 0x99, 0x7D, 0xA4, 0x07, 0x87, 0x6B, 0x3D, 0x79, 0xC0, 0xD9, 0x23, 0x25, 0xAD, 0x3B,
+		0x89, 0xCB, 0xB7, 0x54, 0xD8, 0x6A, 0xB7, 0x1A, 0xEE, 0x04, 0x7A, 0xD3, 0x45, 0xFD, 0x2C, 0x49
+	};
+	/* Shape of a stored credential: 8 byte salt as key, 5 digits, 8 byte digest */
+	static const uint8 credential64[8] = { 0xB6, 0xC8, 0x45, 0x31, 0x18, 0xC0, 0x4F, 0x68 };
+	static const uint8 digits[5] = { 1, 2, 3, 4, 5 };
+	uint8 key[32];
+	uint8 digest[32];
+	uint8 i;
+
+	printf("\nBLAKE2s\n");
+
+	for (i = 0; i < 32; i++)
+		key[i] = i;
+
+	BLAKE2S_compute(digest, 32, NULL_PTR, 0, (const uint8 *) "abc", 3);
+	BENCH_check(memcmp(digest, abc256, 32) == 0, "BLAKE2s-256(\"abc\")");
+	BLAKE2S_compute(digest, 32, key, 32, NULL_PTR, 0);
+	BENCH_check(memcmp(digest, keyedEmpty256, 32) == 0, "keyed BLAKE2s-256 of nothing");
+	BLAKE2S_compute(digest, 8, key, 8, digits, 5);
+	BENCH_check(memcmp(digest, credential64, 8) == 0, "keyed 64 bit digest of 5 digits");
+
+	digest[7] ^= 0x01;
+	BENCH_check(BLAKE2S_equal(digest, digest, 8) && !BLAKE2S_equal(digest, credential64, 8),
+			"BLAKE2S_equal");
+}
+
+/* Packed password encoding of the requests, checked byte for byte */
+static void BENCH_checkPassword(void) {
+	static const uint8 digits[PASSWORD_MAX_LENGTH] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6 };
+	static const uint8 packed5[PASSWORD_PACKED_SIZE(5)] = { 5, 0x12, 0x34, 0x5F };
+	uint8 packed[PASSWORD_MAX_PACKED_SIZE];
+	uint8 unpacked[PASSWORD_MAX_LENGTH];
+	uint8 length;
+	uint8 unpackedLength;
+	uint8 size;
+	boolean ok = TRUE;
+
+	printf("\nPacked passwords\n");
+
+	BENCH_check(PASSWORD_pack(digits, 5, packed) == sizeof(packed5)
+			&& memcmp(packed, packed5, sizeof(packed5)) == 0, "5 digits in 4 bytes");
+
+	for (length = PASSWORD_MIN_LENGTH; length <= PASSWORD_MAX_LENGTH; length++) {
+		size = PASSWORD_pack(digits, length, packed);
+		ok = ok && size == PASSWORD_PACKED_SIZE(length)
+				&& PASSWORD_unpack(packed, size, unpacked, &unpackedLength) == size
+				&& unpackedLength == length && memcmp(unpacked, digits, length) == 0
+				&& PASSWORD_unpack(packed, size - 1, unpacked, &unpackedLength) == 0;
+	}
+	BENCH_check(ok, "every length back and forth");
+
+	BENCH_check(PASSWORD_pack(digits, PASSWORD_MIN_LENGTH - 1, packed) == 0
+			&& PASSWORD_pack(digits, PASSWORD_MAX_LENGTH + 1, packed) == 0, "lengths out of range");
+	memcpy(packed, packed5, sizeof(packed5));
+	packed[3] = 0x50;
+	ok = PASSWORD_unpack(packed, sizeof(packed5), unpacked, &length) == 0;
+	packed[3] = 0x5F;
+	packed[1] = 0xA2;
+	BENCH_check(ok && PASSWORD_unpack(packed, sizeof(packed5), unpacked, &length) == 0,
+			"bad pad nibble and digit refused");
+}
+
+/* Two byte addressing and block operations across the two chips */
+static void BENCH_runMultiChip(void) {
+	EEPROM_ConfigType EEPROM_Config_Data = { g_driver24C32, 2 };
+	EEPROM_ConfigType EEPROM_SamePins_Data = { g_driverSamePins, 2 };
+	EEPROM_ConfigType EEPROM_Blocks_Data = { g_driverBlocks, 2 };
+	uint8 *memory[2];
+	uint64 start;
+	uint16 i;
+	uint8 value;
+	boolean ok;
+
+	printf("\nTwo 24C32, %lu kbps\n", (unsigned long) (BENCH_BIT_RATE / 1000));
+
+	EEPROM_MODEL_detachAll();
+	for (i = 0; i < 2; i++) {
+		if (EEPROM_MODEL_attach(&g_device24C32[i]) < 0) {
+			BENCH_check(FALSE, "attach the 24C32 models");
+			return;
+		}
+		memory[i] = EEPROM_MODEL_getMemory(i);
+	}
+	BENCH_check(EEPROM_init(&EEPROM_Config_Data) == SUCCESS && EEPROM_getCapacity() == 8192,
+			"8 KB address space");
+	BENCH_check(EEPROM_init(&EEPROM_SamePins_Data) == ERROR && EEPROM_init(&EEPROM_Blocks_Data) == ERROR
+			&& EEPROM_getCapacity() == 8192, "chips sharing a device address refused");
+
+	for (i = 0; i < 1024; i++)
+		g_pattern[i] = (uint8) (i * 13 + 5);
+
+	/* 0x0E00 .. 0x11FF: the last 512 bytes of chip 0 and the first 512 of chip 1 */
+	start = SIM_getTimeNs();
+	ok = (EEPROM_writeBlock(0x0E00, g_pattern, 1024) == SUCCESS);
+	BENCH_report("writeBlock 1024 B across the chips", SIM_getTimeNs() - start, 1024);
+	BENCH_check(ok && memcmp(&memory[0][0x0E00], g_pattern, 512) == 0
+			&& memcmp(&memory[1][0x0000], &g_pattern[512], 512) == 0, "writeBlock data split on the chips");
+
+	start = SIM_getTimeNs();
+	ok = (EEPROM_readBlock(0x0E00, g_readBack, 1024) == SUCCESS);
+	BENCH_report("readBlock 1024 B across the chips", SIM_getTimeNs() - start, 1024);
+	BENCH_check(ok && memcmp(g_readBack, g_pattern, 1024) == 0, "readBlock data across the chips");
+
+	ok = (EEPROM_writeByte(0x1FFF, 0x3C) == SUCCESS) && memory[1][0x0FFF] == 0x3C
+			&& EEPROM_readByte(0x1FFF, &value) == SUCCESS && value == 0x3C;
+	BENCH_check(ok, "last byte of chip 1 with the 2 address bytes");
+	BENCH_check(EEPROM_readBlock(0x1FFF, g_readBack, 2) == ERROR
+			&& !PERSIST_write(0x1FF8, g_pattern, 16), "accesses past the last chip refused");
+
+	/* The queue crosses the chips too, one page on each side */
+	ok = PERSIST_write(0x0FF0, &g_pattern[0x100], 16) && PERSIST_write(0x1000, &g_pattern[0x110], 16);
+	PERSIST_flush();
+	BENCH_check(ok && memcmp(&memory[0][0x0FF0], &g_pattern[0x100], 16) == 0
+			&& memcmp(&memory[1][0x0000], &g_pattern[0x110], 16) == 0, "queued pages on both chips");
+	BENCH_check(EEPROM_getErrorCount() == 0 && PERSIST_getErrorCount() == 0, "no operation failed");
+}
+
+/* Log store and audit log on the RAM storage, across wrap-arounds and resets */
+static void BENCH_runRecords(void) {
+	LOGSTORE_ConfigType LOGSTORE_Config_Data = { BENCH_STORE_START, BENCH_STORE_SLOTS };
+	AUDIT_ConfigType AUDIT_Config_Data = { 0x0000, BENCH_AUDIT_PAGES };
+	AUDIT_EventType event;
+	uint8 data[LOGSTORE_MAX_PAYLOAD];
+	uint8 value[2];
+	uint8 length;
+	uint16 i;
+	uint16 seq;
+	boolean ok;
+
+	printf("\nLog store and audit log, RAM storage\n");
+
+	STORAGE_init();
+	BENCH_check(LOGSTORE_init(&LOGSTORE_Config_Data) == SUCCESS
+			&& LOGSTORE_read(0, data, &length) == ERROR, "empty region");
+
+	/* A key written once, then three keys rewritten until the region wrapped several times */
+	value[0] = 0xAB;
+	ok = (LOGSTORE_write(5, value, 1) == SUCCESS);
+	for (i = 0; i < 200; i++) {
+		value[0] = (uint8) i;
+		value[1] = (uint8) (i >> 8);
+		ok = ok && LOGSTORE_write(i % 3, value, 2) == SUCCESS;
+	}
+	BENCH_check(ok, "200 records through 53 slots");
+
+	/* Reset: everything comes from the scan */
+	ok = (LOGSTORE_init(&LOGSTORE_Config_Data) == SUCCESS);
+	for (i = 197; i < 200; i++) {
+		ok = ok && LOGSTORE_read(i % 3, data, &length) == SUCCESS && length == 2
+				&& data[0] == (uint8) i && data[1] == (uint8) (i >> 8);
+	}
+	BENCH_check(ok, "newest version of every key after a reset");
+	BENCH_check(LOGSTORE_read(5, data, &length) == SUCCESS && length == 1 && data[0] == 0xAB,
+			"key written once survives the wrap-arounds");
+	BENCH_check(LOGSTORE_write(5, NULL_PTR, 0) == SUCCESS
+			&& LOGSTORE_read(5, data, &length) == SUCCESS && length == 0
+			&& LOGSTORE_write(LOGSTORE_MAX_KEYS, value, 1) == ERROR, "empty record, bad key refused");
+
+	/* 30 events: 7 full pages written, 2 events left in RAM */
+	ok = (AUDIT_init(&AUDIT_Config_Data) == SUCCESS);
+	for (i = 0; i < 30; i++) {
+		AUDIT_log(AUDIT_UNLOCK, (uint8) i);
+	}
+	ok = ok && AUDIT_read(0, &event) == SUCCESS && event.user == 29
+			&& AUDIT_read(29, &event) == SUCCESS && event.user == 0 && event.seq == 0
+			&& AUDIT_read(30, &event) == ERROR;
+	BENCH_check(ok, "events newest first");
+
+	/* Reset: the events not written yet are lost, the numbering goes on after the stored ones */
+	ok = (AUDIT_init(&AUDIT_Config_Data) == SUCCESS)
+			&& AUDIT_read(0, &event) == SUCCESS && event.user == 27;
+	AUDIT_log(AUDIT_LOCKOUT, 0);
+	ok = ok && AUDIT_read(0, &event) == SUCCESS && event.type == AUDIT_LOCKOUT && event.seq == 28;
+	BENCH_check(ok, "stored events kept across a reset");
+
+	/* A lockout is written in a partial page at once, the page is filled after the reset */
+	ok = (AUDIT_init(&AUDIT_Config_Data) == SUCCESS)
+			&& AUDIT_read(0, &event) == SUCCESS && event.type == AUDIT_LOCKOUT && event.seq == 28
+			&& AUDIT_read(1, &event) == SUCCESS && event.user == 27;
+	AUDIT_log(AUDIT_UNLOCK, 1);
+	ok = ok && AUDIT_read(0, &event) == SUCCESS && event.user == 1 && event.seq == 29
+			&& AUDIT_read(1, &event) == SUCCESS && event.seq == 28;
+	BENCH_check(ok, "partial page kept across a reset");
+
+	/* Past the region size the oldest pages are overwritten, a partial page takes the oldest one */
+	for (i = 0; i < 100; i++) {
+		AUDIT_log(AUDIT_FAILED_ATTEMPT, (uint8) i);
+	}
+	ok = (AUDIT_read(0, &event) == SUCCESS && event.user == 99);
+	seq = event.seq;
+	for (i = 1; AUDIT_read(i, &event) == SUCCESS; i++) {
+		ok = ok && event.seq == (uint16) (seq - i);
+	}
+	BENCH_check(ok && i >= (BENCH_AUDIT_PAGES - 1) * AUDIT_EVENTS_PER_PAGE,
+			"consecutive events after the region wrapped");
+
+	ok = (AUDIT_init(&AUDIT_Config_Data) == SUCCESS)
+			&& AUDIT_read(0, &event) == SUCCESS && event.user == 99 && event.seq == seq;
+	for (i = 1; AUDIT_read(i, &event) == SUCCESS; i++) {
+		ok = ok && event.seq == (uint16) (seq - i);
+	}
+	BENCH_check(ok && i >= (BENCH_AUDIT_PAGES - 1) * AUDIT_EVENTS_PER_PAGE && AUDIT_getDroppedCount() == 0,
+			"failed attempts kept across a reset after the region wrapped");
+}
+
+/*
+ * Power loss while a record is written: only the first half of its page reached the
+ * cells. The scan must drop it, keep the previous version and number the next record
+ * right after the newest valid one.
+ */
+static void BENCH_runTornWrite(void) {
+	LOGSTORE_ConfigType LOGSTORE_Config_Data = { BENCH_STORE_START, BENCH_STORE_SLOTS };
+	static const uint8 erased[LOGSTORE_SLOT_SIZE / 2] = {
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+	};
+	uint8 data[LOGSTORE_MAX_PAYLOAD];
+	uint8 length;
+	uint16 seq;
+	uint16 oldSeq;
+	uint16 errors;
+	uint8 flipped;
+	uint8 i;
+	boolean ok;
+
+	printf("\nLog store power loss\n");
+
+	/* Erased region: the records go to slots 0, 1, 2 ... with sequence numbers 1, 2, 3 ... */
+	STORAGE_init();
+	ok = (LOGSTORE_init(&LOGSTORE_Config_Data) == SUCCESS)
+			&& LOGSTORE_write(7, (const uint8 *) "old", 3) == SUCCESS
+			&& LOGSTORE_write(7, (const uint8 *) "new", 3) == SUCCESS;
+
+	/* Second half of slot 1 never programmed */
+	ok = ok && STORAGE_write(BENCH_STORE_START + LOGSTORE_SLOT_SIZE + sizeof(erased), erased,
+			sizeof(erased));
+	ok = ok && LOGSTORE_init(&LOGSTORE_Config_Data) == SUCCESS
+			&& LOGSTORE_read(7, data, &length) == SUCCESS && length == 3
+			&& memcmp(data, "old", 3) == 0;
+	BENCH_check(ok, "torn record dropped, previous version kept");
+
+	/* The next record takes the torn slot with the next sequence number */
+	ok = (LOGSTORE_write(7, (const uint8 *) "nxt", 3) == SUCCESS)
+			&& STORAGE_read(BENCH_STORE_START, (uint8 *) &oldSeq, sizeof(oldSeq)) == SUCCESS
+			&& STORAGE_read(BENCH_STORE_START + LOGSTORE_SLOT_SIZE, (uint8 *) &seq, sizeof(seq))
+					== SUCCESS && seq == (uint16) (oldSeq + 1);
+	ok = ok && LOGSTORE_init(&LOGSTORE_Config_Data) == SUCCESS
+			&& LOGSTORE_read(7, data, &length) == SUCCESS && memcmp(data, "nxt", 3) == 0;
+	BENCH_check(ok, "numbering goes on after the newest valid record");
+
+	/* One bit flipped in the payload of the newest record */
+	ok = STORAGE_read(BENCH_STORE_START + LOGSTORE_SLOT_SIZE + 4, &flipped, 1) == SUCCESS;
+	flipped ^= 0x10;
+	ok = ok && STORAGE_write(BENCH_STORE_START + LOGSTORE_SLOT_SIZE + 4, &flipped, 1)
+			&& LOGSTORE_init(&LOGSTORE_Config_Data) == SUCCESS
+			&& LOGSTORE_read(7, data, &length) == SUCCESS && memcmp(data, "old", 3) == 0;
+	BENCH_check(ok, "corrupted record dropped by its CRC");
+
+	/* The storage takes the record then gives it up: the old slot stays live through a wrap */
+	errors = LOGSTORE_getErrorCount();
+	STORAGE_RAM_dropWrites(1);
+	ok = (LOGSTORE_write(7, (const uint8 *) "bad", 3) == ERROR)
+			&& LOGSTORE_getErrorCount() == errors + 1;
+	for (i = 0; i < BENCH_STORE_SLOTS; i++) {
+		ok = ok && LOGSTORE_write(8, (const uint8 *) &i, sizeof(i)) == SUCCESS;
+	}
+	ok = ok && LOGSTORE_read(7, data, &length) == SUCCESS && memcmp(data, "old", 3) == 0
+			&& LOGSTORE_init(&LOGSTORE_Config_Data) == SUCCESS
+			&& LOGSTORE_read(7, data, &length) == SUCCESS && memcmp(data, "old", 3) == 0;
+	BENCH_check(ok, "write given up by the storage, previous version kept");
+}
+
+/* Wrong password lockout on the simulated clock, its streak in the log store */
+static void BENCH_runLockout(void) {
+	LOGSTORE_ConfigType LOGSTORE_Config_Data = { BENCH_STORE_START, BENCH_STORE_SLOTS };
+	LOCKOUT_ConfigType LOCKOUT_Config_Data = { BENCH_LOCKOUT_KEY, 3, 60, 7 };
+	uint8 i;
+	boolean ok;
+
+	printf("\nWrong password lockout\n");
+
+	CLOCK_init();
+	LOGSTORE_init(&LOGSTORE_Config_Data);
+	LOCKOUT_init(&LOCKOUT_Config_Data);
+	ok = (LOCKOUT_getRemaining() == 0) && !LOCKOUT_fail() && !LOCKOUT_fail();
+	BENCH_check(ok && LOCKOUT_fail() && LOCKOUT_getRemaining() == 60, "3rd wrong password: 60 s");
+
+	SIM_advanceNs(60000000000ULL);
+	ok = (LOCKOUT_getRemaining() == 0);
+	BENCH_check(ok && LOCKOUT_fail() && LOCKOUT_getRemaining() == 120, "next one after it: 120 s");
+
+	/* Reset 30 s into the lockout: it starts again in full */
+	SIM_advanceNs(30000000000ULL);
+	CLOCK_init();
+	LOGSTORE_init(&LOGSTORE_Config_Data);
+	LOCKOUT_init(&LOCKOUT_Config_Data);
+	BENCH_check(LOCKOUT_getRemaining() == 120, "a reset does not shorten the lockout");
+
+	ok = TRUE;
+	for (i = 0; i < 20; i++) {
+		SIM_advanceNs((uint64) (LOCKOUT_getRemaining()) * 1000000000ULL);
+		ok = ok && LOCKOUT_fail();
+	}
+	BENCH_check(ok && LOCKOUT_getRemaining() == (60U << 7), "longest lockout: 60 s << 7");
+
+	SIM_advanceNs((uint64) (LOCKOUT_getRemaining()) * 1000000000ULL);
+	LOCKOUT_succeed();
+	LOGSTORE_init(&LOGSTORE_Config_Data);
+	LOCKOUT_init(&LOCKOUT_Config_Data);
+	BENCH_check(LOCKOUT_getRemaining() == 0 && !LOCKOUT_fail(), "a correct password clears the streak");
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void) {
+	TWI_ConfigType TWI_Config_Data = { BENCH_BIT_RATE, 1 };
+	sint8 device = EEPROM_MODEL_attach(&g_device24C16);
+
+	if (device < 0) {
+		printf("bad model configuration\n");
+		return 1;
+	}
+	g_device = (uint8) device;
+	TWI_init(&TWI_Config_Data);
+
+	BENCH_checkModel();
+	BENCH_settle();
+	BENCH_runDriver();
+	BENCH_runQueue();
+	BENCH_runMultiChip();
+	BENCH_checkHash();
+	BENCH_checkPassword();
+	BENCH_runRecords();
+	BENCH_runTornWrite();
+	BENCH_runLockout();
+
+	printf("\n%u check(s) failed\n", g_failures);
+	return (g_failures == 0) ? 0 : 1;
+}
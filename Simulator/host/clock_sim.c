@@ -0,0 +1,33 @@
+/******************************************************************************
+ *
+ * Module: Clock - Host Simulation
+ *
+ * File Name: clock_sim.c
+ *
+ * Description: Host implementation of clock.h on the simulation clock, the seconds
+ * go on while the bench advances the simulated time.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "clock.h"
+#include "sim.h"
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+static uint64 g_startNs = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void CLOCK_init(void) {
+	g_startNs = SIM_getTimeNs();
+}
+
+uint32 CLOCK_getSeconds(void) {
+	return (uint32) ((SIM_getTimeNs() - g_startNs) / 1000000000ULL);
+}
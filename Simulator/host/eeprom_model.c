@@ -0,0 +1,257 @@
+/******************************************************************************
+ *
+ * Module: EEPROM Model
+ *
+ * File Name: eeprom_model.c
+ *
+ * Description: Source file for the 24Cxx serial EEPROM model of the host build
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "eeprom_model.h"
+#include "sim.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+typedef enum{
+	MODEL_IDLE, MODEL_ADDRESS, MODEL_WRITE, MODEL_READ
+}EEPROM_MODEL_StateType;
+
+typedef struct{
+	EEPROM_MODEL_ConfigType config;
+	uint8 *memory;
+	uint32 *wear;                           /* Write cycles of every byte */
+	uint8 blockBits;                        /* Device address bits used as memory address bits */
+
+	EEPROM_MODEL_StateType state;
+	uint32 counter;                         /* Internal address counter */
+	uint8 addressCount;                     /* Address bytes received in MODEL_ADDRESS */
+	uint8 page[EEPROM_MODEL_MAX_PAGE];      /* Page buffer and the bytes latched in it */
+	boolean latched[EEPROM_MODEL_MAX_PAGE];
+	boolean pending;
+	uint64 busyUntilNs;
+
+	EEPROM_MODEL_StatsType stats;
+}EEPROM_MODEL_DeviceType;
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+static EEPROM_MODEL_DeviceType g_devices[EEPROM_MODEL_MAX_DEVICES];
+static uint8 g_deviceCount = 0;
+
+static boolean g_expectAddress = FALSE;         /* The next byte is a device address */
+static EEPROM_MODEL_DeviceType *g_selected = NULL_PTR;
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+static boolean EEPROM_MODEL_isPowerOfTwo(uint32 value) {
+	return value != 0 && (value & (value - 1)) == 0;
+}
+
+/* Device answering the device address sla, NULL_PTR if none */
+static EEPROM_MODEL_DeviceType *EEPROM_MODEL_find(uint8 sla) {
+	uint8 pins = (sla >> 1) & 0x07;
+	uint8 chipMask;
+
+	if ((sla & 0xF0) != 0xA0)
+		return NULL_PTR;
+
+	for (uint8 i = 0; i < g_deviceCount; i++) {
+		chipMask = 0x07 & ~((1 << g_devices[i].blockBits) - 1);
+		if ((pins & chipMask) == (g_devices[i].config.chip_address & chipMask))
+			return &g_devices[i];
+	}
+	return NULL_PTR;
+}
+
+/* Program the latched bytes of the page buffer, the write cycle starts */
+static void EEPROM_MODEL_program(EEPROM_MODEL_DeviceType *device) {
+	uint16 pageSize = device->config.page_size;
+	uint32 base = device->counter & ~((uint32) pageSize - 1);
+
+	for (uint16 i = 0; i < pageSize; i++) {
+		if (!device->latched[i])
+			continue;
+		device->memory[base + i] = device->page[i];
+		if (++device->wear[base + i] > device->stats.max_cell_writes)
+			device->stats.max_cell_writes = device->wear[base + i];
+		device->stats.bytes_written++;
+	}
+
+	device->stats.write_cycles++;
+	device->busyUntilNs = SIM_getTimeNs() + (uint64) device->config.write_cycle_us * 1000ULL;
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+sint8 EEPROM_MODEL_attach(const EEPROM_MODEL_ConfigType *Config_Ptr) {
+	EEPROM_MODEL_DeviceType *device;
+	uint32 blocks;
+
+	if (g_deviceCount == EEPROM_MODEL_MAX_DEVICES
+			|| !EEPROM_MODEL_isPowerOfTwo(Config_Ptr->size)
+			|| !EEPROM_MODEL_isPowerOfTwo(Config_Ptr->page_size)
+			|| Config_Ptr->page_size > EEPROM_MODEL_MAX_PAGE
+			|| Config_Ptr->page_size > Config_Ptr->size
+			|| (Config_Ptr->address_bytes == 1 && Config_Ptr->size > 2048)
+			|| (Config_Ptr->address_bytes == 2 && Config_Ptr->size > 65536)
+			|| (Config_Ptr->address_bytes != 1 && Config_Ptr->address_bytes != 2)) {
+		return -1;
+	}
+
+	device = &g_devices[g_deviceCount];
+	memset(device, 0, sizeof(*device));
+	device->config = *Config_Ptr;
+	device->memory = malloc(Config_Ptr->size);
+	device->wear = calloc(Config_Ptr->size, sizeof(uint32));
+	if (device->memory == NULL_PTR || device->wear == NULL_PTR)
+		return -1;
+	memset(device->memory, 0xFF, Config_Ptr->size);
+
+	/* 24C04 .. 24C16 take the 256 byte block number in the device address */
+	if (Config_Ptr->address_bytes == 1) {
+		for (blocks = Config_Ptr->size >> 8; blocks > 1; blocks >>= 1)
+			device->blockBits++;
+	}
+
+	return (sint8) g_deviceCount++;
+}
+
+void EEPROM_MODEL_detachAll(void) {
+	for (uint8 i = 0; i < g_deviceCount; i++) {
+		free(g_devices[i].memory);
+		free(g_devices[i].wear);
+	}
+	g_deviceCount = 0;
+	g_selected = NULL_PTR;
+	g_expectAddress = FALSE;
+}
+
+uint8 *EEPROM_MODEL_getMemory(uint8 device) {
+	return g_devices[device].memory;
+}
+
+boolean EEPROM_MODEL_isBusy(uint8 device) {
+	return SIM_getTimeNs() < g_devices[device].busyUntilNs;
+}
+
+void EEPROM_MODEL_getStats(uint8 device, EEPROM_MODEL_StatsType *Stats_Ptr) {
+	*Stats_Ptr = g_devices[device].stats;
+}
+
+void EEPROM_MODEL_resetStats(uint8 device) {
+	uint32 maxWrites = g_devices[device].stats.max_cell_writes;
+
+	/* The wear is a property of the cells, it survives a reset of the counters */
+	memset(&g_devices[device].stats, 0, sizeof(EEPROM_MODEL_StatsType));
+	g_devices[device].stats.max_cell_writes = maxWrites;
+}
+
+void EEPROM_MODEL_start(void) {
+	/* A START before the STOP aborts a write, nothing is programmed */
+	if (g_selected != NULL_PTR) {
+		g_selected->pending = FALSE;
+		g_selected->state = MODEL_IDLE;
+	}
+	g_selected = NULL_PTR;
+	g_expectAddress = TRUE;
+}
+
+boolean EEPROM_MODEL_write(uint8 data) {
+	EEPROM_MODEL_DeviceType *device;
+	uint16 offset;
+
+	if (g_expectAddress) {
+		g_expectAddress = FALSE;
+		device = EEPROM_MODEL_find(data);
+		if (device == NULL_PTR)
+			return FALSE;
+		if (SIM_getTimeNs() < device->busyUntilNs) {
+			device->stats.busy_nacks++;
+			return FALSE;
+		}
+
+		g_selected = device;
+		if (data & 1) {
+			/* Read from the current address counter */
+			device->state = MODEL_READ;
+		} else {
+			device->state = MODEL_ADDRESS;
+			device->addressCount = 0;
+			device->counter = 0;
+			if (device->blockBits != 0)
+				device->counter = (uint32) ((data >> 1) & ((1 << device->blockBits) - 1)) << 8;
+		}
+		return TRUE;
+	}
+
+	device = g_selected;
+	if (device == NULL_PTR)
+		return FALSE;
+
+	switch (device->state) {
+	case MODEL_ADDRESS:
+		if (device->config.address_bytes == 2 && device->addressCount == 0)
+			device->counter = (uint32) data << 8;
+		else
+			device->counter |= data;
+		if (++device->addressCount == device->config.address_bytes) {
+			device->counter &= device->config.size - 1;
+			memset(device->latched, 0, sizeof(device->latched));
+			device->pending = FALSE;
+			device->state = MODEL_WRITE;
+		}
+		return TRUE;
+
+	case MODEL_WRITE:
+		/* Latch in the page buffer, the counter rolls over inside the page */
+		offset = device->counter & (device->config.page_size - 1);
+		device->page[offset] = data;
+		device->latched[offset] = TRUE;
+		device->pending = TRUE;
+		device->counter = (device->counter & ~((uint32) device->config.page_size - 1))
+				| ((offset + 1) & (device->config.page_size - 1));
+		return TRUE;
+
+	default:
+		/* A device does not take data while it sends */
+		return FALSE;
+	}
+}
+
+uint8 EEPROM_MODEL_read(void) {
+	EEPROM_MODEL_DeviceType *device = g_selected;
+	uint8 data;
+
+	/* Nobody drives SDA: the pull-up reads as 1 */
+	if (device == NULL_PTR || device->state != MODEL_READ)
+		return 0xFF;
+
+	data = device->memory[device->counter];
+	device->counter = (device->counter + 1) & (device->config.size - 1);
+	device->stats.bytes_read++;
+	return data;
+}
+
+void EEPROM_MODEL_stop(void) {
+	if (g_selected != NULL_PTR) {
+		if (g_selected->state == MODEL_WRITE && g_selected->pending)
+			EEPROM_MODEL_program(g_selected);
+		g_selected->pending = FALSE;
+		g_selected->state = MODEL_IDLE;
+	}
+	g_selected = NULL_PTR;
+	g_expectAddress = FALSE;
+}
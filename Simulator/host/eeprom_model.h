@@ -0,0 +1,94 @@
+/******************************************************************************
+ *
+ * Module: EEPROM Model
+ *
+ * File Name: eeprom_model.h
+ *
+ * Description: Header file for the 24Cxx serial EEPROM model of the host build.
+ * The devices attached to the simulated bus behave like the datasheet describes:
+ *  - A write is latched in a page buffer and the address counter rolls over inside
+ *    the page, the page is programmed by the STOP condition.
+ *  - During the write cycle (tWR) the device NACKs its address.
+ *  - 24C01..24C16 take the block bits A8..A10 in the device address and one address
+ *    byte, 24C32..24C512 take two address bytes and use A2..A0 as chip select pins.
+ *  - A sequential read rolls over from the last byte of the memory to the first one.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef EEPROM_MODEL_H_
+#define EEPROM_MODEL_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define EEPROM_MODEL_MAX_DEVICES    8       /* One per value of the A2..A0 pins */
+#define EEPROM_MODEL_MAX_PAGE       256
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+typedef struct{
+	uint32 size;                /* Bytes, a power of two: 128 (24C01) .. 65536 (24C512) */
+	uint16 page_size;           /* Bytes of the page buffer, a power of two */
+	uint8 address_bytes;        /* 1: 24C01..24C16, 2: 24C32..24C512 */
+	uint8 chip_address;         /* Level of the A2..A0 pins, the pins used as block bits are ignored */
+	uint16 write_cycle_us;      /* tWR */
+}EEPROM_MODEL_ConfigType;
+
+typedef struct{
+	uint32 bytes_read;
+	uint32 bytes_written;       /* Bytes programmed by the write cycles */
+	uint32 write_cycles;
+	uint32 busy_nacks;          /* Addresses NACKed because a write cycle was running */
+	uint32 max_cell_writes;     /* Write cycles seen by the most worn byte */
+}EEPROM_MODEL_StatsType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Attach an erased device to the bus. Returns its index, or -1 for a bad configuration
+ * or when EEPROM_MODEL_MAX_DEVICES are attached.
+ */
+sint8 EEPROM_MODEL_attach(const EEPROM_MODEL_ConfigType *Config_Ptr);
+
+/*
+ * Description :
+ * Remove every device from the bus, to attach another set.
+ */
+void EEPROM_MODEL_detachAll(void);
+
+/*
+ * Description :
+ * Direct access to the cells of a device, to check or corrupt them without the bus.
+ */
+uint8 *EEPROM_MODEL_getMemory(uint8 device);
+
+/*
+ * Description :
+ * Return TRUE while the device runs a write cycle.
+ */
+boolean EEPROM_MODEL_isBusy(uint8 device);
+
+void EEPROM_MODEL_getStats(uint8 device, EEPROM_MODEL_StatsType *Stats_Ptr);
+void EEPROM_MODEL_resetStats(uint8 device);
+
+/*
+ * Description :
+ * Bus side, called by the TWI model for every START (repeated or not), byte sent by
+ * the master (returns TRUE if a device ACKed it), byte read by the master and STOP.
+ */
+void EEPROM_MODEL_start(void);
+boolean EEPROM_MODEL_write(uint8 data);
+uint8 EEPROM_MODEL_read(void);
+void EEPROM_MODEL_stop(void);
+
+#endif /* EEPROM_MODEL_H_ */
@@ -0,0 +1,20 @@
+/******************************************************************************
+ *
+ * Module: Host Simulation
+ *
+ * File Name: interrupt.h
+ *
+ * Description: Host stand-in for <avr/interrupt.h>. The simulated TWI interrupt only
+ * runs while the simulation clock advances, so a critical section needs nothing.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef SIM_AVR_INTERRUPT_H_
+#define SIM_AVR_INTERRUPT_H_
+
+#define cli()   ((void)0)
+#define sei()   ((void)0)
+
+#endif /* SIM_AVR_INTERRUPT_H_ */
@@ -0,0 +1,20 @@
+/******************************************************************************
+ *
+ * Module: Host Simulation
+ *
+ * File Name: io.h
+ *
+ * Description: Host stand-in for <avr/io.h>, only what the Control ECU storage
+ * modules use outside the TWI driver (which is replaced by twi_sim.c)
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef SIM_AVR_IO_H_
+#define SIM_AVR_IO_H_
+
+/* Saved and restored around critical sections, defined in sim.c */
+extern volatile unsigned char SREG;
+
+#endif /* SIM_AVR_IO_H_ */
@@ -0,0 +1,20 @@
+/******************************************************************************
+ *
+ * Module: Host Simulation
+ *
+ * File Name: pgmspace.h
+ *
+ * Description: Host stand-in for <avr/pgmspace.h>, flash and RAM are one address
+ * space on the host
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef SIM_AVR_PGMSPACE_H_
+#define SIM_AVR_PGMSPACE_H_
+
+#define PROGMEM
+#define pgm_read_byte(address)  (*(const unsigned char *)(address))
+
+#endif /* SIM_AVR_PGMSPACE_H_ */
@@ -0,0 +1,22 @@
+/******************************************************************************
+ *
+ * Module: Host Simulation
+ *
+ * File Name: delay.h
+ *
+ * Description: Host stand-in for <util/delay.h>, a busy wait advances the
+ * simulation clock instead of burning CPU cycles
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef SIM_UTIL_DELAY_H_
+#define SIM_UTIL_DELAY_H_
+
+#include "sim.h"
+
+#define _delay_us(us)   SIM_delayUs((uint32)(us))
+#define _delay_ms(ms)   SIM_delayUs((uint32)(ms) * 1000UL)
+
+#endif /* SIM_UTIL_DELAY_H_ */
@@ -0,0 +1,47 @@
+/******************************************************************************
+ *
+ * Module: Host Simulation
+ *
+ * File Name: sim.c
+ *
+ * Description: Source file for the simulation clock of the host build
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "sim.h"
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+/* Status register of <avr/io.h>, only saved and restored by the code under test */
+volatile unsigned char SREG = 0;
+
+static uint64 g_timeNs = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+uint64 SIM_getTimeNs(void) {
+	return g_timeNs;
+}
+
+void SIM_advanceNs(uint64 ns) {
+	uint64 target = g_timeNs + ns;
+	uint64 event;
+
+	/* A step may schedule the next one before target, run them all */
+	while ((event = TWI_SIM_nextEvent()) <= target) {
+		if (event > g_timeNs)
+			g_timeNs = event;
+		TWI_SIM_service();
+	}
+	g_timeNs = target;
+}
+
+void SIM_delayUs(uint32 us) {
+	SIM_advanceNs((uint64) us * 1000ULL);
+}
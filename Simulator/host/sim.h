@@ -0,0 +1,57 @@
+/******************************************************************************
+ *
+ * Module: Host Simulation
+ *
+ * File Name: sim.h
+ *
+ * Description: Header file for the simulation clock of the host build.
+ * Time only moves when the code under test waits (_delay_us, _delay_ms) or drives
+ * the bus, the TWI model runs its interrupt steps at their due time meanwhile.
+ * CPU time of the code itself is not modelled, only bus and device time.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define SIM_NO_EVENT    0xFFFFFFFFFFFFFFFFULL
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Return the simulation time in nanoseconds since the start.
+ */
+uint64 SIM_getTimeNs(void);
+
+/*
+ * Description :
+ * Advance the simulation time, the TWI steps falling due are run in order.
+ */
+void SIM_advanceNs(uint64 ns);
+
+/*
+ * Description :
+ * _delay_us of the host build.
+ */
+void SIM_delayUs(uint32 us);
+
+/*
+ * Description :
+ * Hooks of the TWI model (twi_sim.c): time of the next interrupt step (SIM_NO_EVENT
+ * when the engine is idle) and the step itself.
+ */
+uint64 TWI_SIM_nextEvent(void);
+void TWI_SIM_service(void);
+
+#endif /* SIM_H_ */
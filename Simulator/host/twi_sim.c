@@ -0,0 +1,254 @@
+/******************************************************************************
+ *
+ * Module: TWI(I2C) - Host Simulation
+ *
+ * File Name: twi_sim.c
+ *
+ * Description: Host implementation of twi.h on top of the 24Cxx model.
+ * The polled functions drive the model byte by byte, every bus step advancing the
+ * simulation clock by its bus time. The interrupt driven engine runs one step per
+ * simulated interrupt, at the time the real TWI module would raise it.
+ *
+ * Author: Hussein El-Shamy
+ *
+ *******************************************************************************/
+
+#include "twi.h"
+#include "sim.h"
+#include "eeprom_model.h"
+
+/*******************************************************************************
+ *                      Preprocessor Macros                                    *
+ *******************************************************************************/
+
+#define TWI_SIM_NO_STATUS   0xF8    /* TWSR when no state is relevant */
+
+/*******************************************************************************
+ *                      User-Defined Types                                     *
+ *******************************************************************************/
+
+/* Next step of the active engine transaction */
+typedef enum{
+	STEP_START, STEP_SLA_W, STEP_TX, STEP_REP_START, STEP_SLA_R, STEP_RX, STEP_STOP
+}TWI_SIM_StepType;
+
+/*******************************************************************************
+ *                      Global Variables                                       *
+ *******************************************************************************/
+
+static uint64 g_bitNs = 10000;          /* 100 kbps until TWI_init */
+
+/* Polled functions */
+static uint8 g_status = TWI_SIM_NO_STATUS;
+static boolean g_addressNext = FALSE;   /* The next byte written is a device address */
+static boolean g_busOwned = FALSE;      /* A START was sent and no STOP yet */
+
+/* Interrupt driven engine */
+static TWI_TransactionType *g_queue[TWI_QUEUE_SIZE];
+static uint8 g_queueHead = 0;
+static uint8 g_queueCount = 0;
+static TWI_SIM_StepType g_step;
+static uint8 g_txIndex;
+static uint8 g_rxIndex;
+static uint64 g_nextEventNs = SIM_NO_EVENT;
+
+/*******************************************************************************
+ *                      Private Functions                                      *
+ *******************************************************************************/
+
+/* Bus time of a START or STOP condition */
+static void TWI_SIM_condition(void) {
+	SIM_advanceNs(g_bitNs);
+}
+
+/* Bus time of a byte and its acknowledge bit */
+static void TWI_SIM_byte(void) {
+	SIM_advanceNs(9 * g_bitNs);
+}
+
+/* End the active transaction and hand it back to its owner */
+static void TWI_SIM_complete(TWI_ResultType result) {
+	TWI_TransactionType *transaction = g_queue[g_queueHead];
+
+	g_queueHead = (g_queueHead + 1) % TWI_QUEUE_SIZE;
+	g_queueCount--;
+
+	/* The next transaction starts before the call back, which may submit another one */
+	if (g_queueCount != 0) {
+		g_step = STEP_START;
+		g_nextEventNs = SIM_getTimeNs() + g_bitNs;
+	} else {
+		g_nextEventNs = SIM_NO_EVENT;
+	}
+
+	transaction->result = result;
+	if (transaction->callBack != NULL_PTR)
+		transaction->callBack(transaction);
+}
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void TWI_init(const TWI_ConfigType* Config_Ptr) {
+	g_bitNs = 1000000000ULL / Config_Ptr->TWI_BaudRate;
+}
+
+void TWI_start(void) {
+	TWI_SIM_condition();
+	EEPROM_MODEL_start();
+	g_status = g_busOwned ? TWI_REP_START : TWI_START;
+	g_busOwned = TRUE;
+	g_addressNext = TRUE;
+}
+
+void TWI_stop(void) {
+	EEPROM_MODEL_stop();
+	TWI_SIM_condition();
+	g_status = TWI_SIM_NO_STATUS;
+	g_busOwned = FALSE;
+	g_addressNext = FALSE;
+}
+
+void TWI_writeByte(uint8 data) {
+	boolean ack = EEPROM_MODEL_write(data);
+
+	TWI_SIM_byte();
+	if (g_addressNext) {
+		if (data & 1)
+			g_status = ack ? TWI_MT_SLA_R_ACK : TWI_MT_SLA_R_NACK;
+		else
+			g_status = ack ? TWI_MT_SLA_W_ACK : TWI_MT_SLA_W_NACK;
+		g_addressNext = FALSE;
+	} else {
+		g_status = ack ? TWI_MT_DATA_ACK : TWI_MT_DATA_NACK;
+	}
+}
+
+uint8 TWI_readByteWithACK(void) {
+	uint8 data = EEPROM_MODEL_read();
+
+	TWI_SIM_byte();
+	g_status = TWI_MR_DATA_ACK;
+	return data;
+}
+
+uint8 TWI_readByteWithNACK(void) {
+	uint8 data = EEPROM_MODEL_read();
+
+	TWI_SIM_byte();
+	g_status = TWI_MR_DATA_NACK;
+	return data;
+}
+
+uint8 TWI_getStatus(void) {
+	return g_status;
+}
+
+boolean TWI_submit(TWI_TransactionType *Transaction_Ptr) {
+	if (g_queueCount == TWI_QUEUE_SIZE)
+		return FALSE;
+
+	Transaction_Ptr->result = TWI_PENDING;
+	g_queue[(g_queueHead + g_queueCount) % TWI_QUEUE_SIZE] = Transaction_Ptr;
+	g_queueCount++;
+
+	if (g_queueCount == 1) {
+		g_step = STEP_START;
+		g_nextEventNs = SIM_getTimeNs() + g_bitNs;
+	}
+	return TRUE;
+}
+
+boolean TWI_isBusy(void) {
+	return (g_queueCount != 0);
+}
+
+boolean TWI_waitIdle(void) {
+	while (g_queueCount != 0)
+		SIM_advanceNs(g_nextEventNs - SIM_getTimeNs());
+	return TRUE;
+}
+
+void TWI_recoverBus(void) {
+	EEPROM_MODEL_stop();
+	g_status = TWI_SIM_NO_STATUS;
+	g_busOwned = FALSE;
+	g_addressNext = FALSE;
+
+	while (g_queueCount != 0)
+		TWI_SIM_complete(TWI_BUS_ERROR);
+}
+
+uint64 TWI_SIM_nextEvent(void) {
+	return g_nextEventNs;
+}
+
+/* One interrupt of the engine, the same sequence as the ISR of twi.c */
+void TWI_SIM_service(void) {
+	TWI_TransactionType *transaction = g_queue[g_queueHead];
+	uint8 writeLength = transaction->header_length + transaction->tx_length;
+	uint8 data;
+
+	switch (g_step) {
+	case STEP_START:
+		EEPROM_MODEL_start();
+		g_txIndex = 0;
+		g_rxIndex = 0;
+		g_step = (writeLength != 0) ? STEP_SLA_W : STEP_SLA_R;
+		g_nextEventNs = SIM_getTimeNs() + 9 * g_bitNs;
+		return;
+
+	case STEP_SLA_W:
+		if (!EEPROM_MODEL_write(transaction->slave_address)) {
+			EEPROM_MODEL_stop();
+			TWI_SIM_complete(TWI_NACK);
+			return;
+		}
+		g_step = STEP_TX;
+		break;
+
+	case STEP_TX:
+		data = (g_txIndex < transaction->header_length) ?
+				transaction->header[g_txIndex] :
+				transaction->tx_data[g_txIndex - transaction->header_length];
+		if (!EEPROM_MODEL_write(data)) {
+			EEPROM_MODEL_stop();
+			TWI_SIM_complete(TWI_NACK);
+			return;
+		}
+		if (++g_txIndex == writeLength)
+			g_step = (transaction->rx_length != 0) ? STEP_REP_START : STEP_STOP;
+		break;
+
+	case STEP_REP_START:
+		EEPROM_MODEL_start();
+		g_step = STEP_SLA_R;
+		g_nextEventNs = SIM_getTimeNs() + 9 * g_bitNs;
+		return;
+
+	case STEP_SLA_R:
+		if (!EEPROM_MODEL_write(transaction->slave_address | 1)) {
+			EEPROM_MODEL_stop();
+			TWI_SIM_complete(TWI_NACK);
+			return;
+		}
+		g_step = STEP_RX;
+		break;
+
+	case STEP_RX:
+		transaction->rx_data[g_rxIndex] = EEPROM_MODEL_read();
+		if (++g_rxIndex == transaction->rx_length)
+			g_step = STEP_STOP;
+		break;
+
+	case STEP_STOP:
+		EEPROM_MODEL_stop();
+		TWI_SIM_complete(TWI_DONE);
+		return;
+	}
+
+	/* The step after a byte: the next byte, or a condition which only takes one bit */
+	g_nextEventNs = SIM_getTimeNs()
+			+ ((g_step == STEP_REP_START || g_step == STEP_STOP) ? g_bitNs : 9 * g_bitNs);
+}